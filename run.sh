@@ -9,12 +9,35 @@ fi
 
 rm -r out/*
 
-read -p "Do you want a remote server run (r) or debug mode(d)? " OPTION
+read -p "Do you want a remote server run (r), debug mode(d), a benchmark(b), a verification(t) or to build the pattern database(p)? " OPTION
+
+#The verification also checks every incremental heuristic against the full one
+FLAGS=""
+if [[ $OPTION == "t" ]]; then
+	FLAGS="-DHEURISTIC_CROSS_CHECK"
+fi
 
 #Compilation commands here
-gcc -o ./out/run -Wall -Wextra -pthread ./src/server_run.c \
+gcc -o ./out/run -Wall -Wextra -pthread $FLAGS ./src/server_run.c \
 						   ./src/server/npuzzle/puzzle/puzzle.c \
+						   ./src/server/npuzzle/puzzle/solution.c \
+						   ./src/server/npuzzle/puzzle/move_pruning.c \
+						   ./src/server/npuzzle/puzzle/random_generator.c \
+						   ./src/server/npuzzle/arena/arena.c \
+						   ./src/server/npuzzle/heuristic/pattern_database.c \
+						   ./src/server/npuzzle/heuristic/walking_distance.c \
 						   ./src/server/npuzzle/solver/solve_multi_threaded.c \
+						   ./src/server/npuzzle/solver/expansion_pool.c \
+						   ./src/server/npuzzle/solver/solve_ida.c \
+						   ./src/server/npuzzle/solver/solve_hda.c \
+						   ./src/server/npuzzle/solver/solve_bidirectional.c \
+						   ./src/server/npuzzle/solver/solve_anytime.c \
+						   ./src/server/npuzzle/solver/solve_reduction.c \
+						   ./src/server/npuzzle/solver/solve_partial_expansion.c \
+						   ./src/server/npuzzle/solver/solve_table.c \
+						   ./src/server/solution_cache/solution_cache.c \
+						   ./src/server/solution_cache/solution_store.c \
+						   ./src/server/solution_cache/solve_registry.c \
 						   ./src/server/remote_server/server.c \
 						   ./src/server/response_builder/response_builder.c \
 						   ./src/server/http_parser/parser.c 
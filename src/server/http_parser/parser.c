@@ -5,6 +5,8 @@
  */
 
 #include "parser.h"
+//For UINT64_MAX
+#include <stdint.h>
 
 /**
  * A non destructive get_next_char method that preserves the original string.
@@ -36,6 +38,8 @@ struct request_details* parse_request(char* http_request){
 	details->type = R_ERR;
 	details->N = -1;
 	details->complexity = -1;
+	details->seed = 0;
+	details->has_seed = 0;
 	
 	//Continuously grab the next character until we hit the end
 	while((c = get_next_char(http_request,   &current_ptr)) != '\0'){
@@ -116,6 +120,59 @@ struct request_details* parse_request(char* http_request){
 				details->N = num - '0';
 				break;
 
+			//If we see this and we are in a post request, this could be the seed that the puzzle should be made from
+			case 's':
+				//If we are not in a post request, then we don't care
+				if(details->type != R_POST){
+					break;
+				}
+
+				//We need to see "eed=" next in the request, if we don't put the chars back and break
+				if(get_next_char(http_request, &current_ptr) != 'e'){
+					current_ptr--;
+					break;
+				}
+
+				if(get_next_char(http_request, &current_ptr) != 'e'){
+					current_ptr -= 2;
+					break;
+				}
+
+				if(get_next_char(http_request, &current_ptr) != 'd'){
+					current_ptr -= 3;
+					break;
+				}
+
+				if(get_next_char(http_request, &current_ptr) != '='){
+					current_ptr -= 4;
+					break;
+				}
+
+				//The seed can have up to 20 digits. A blank seed just means that the server picks one
+				u_int64_t seed = 0;
+				int digits = 0;
+				char digit;
+				while((digit = get_next_char(http_request, &current_ptr)) >= '0' && digit <= '9'){
+					//Anything that doesn't fit into 64 bits is a bad request
+					if(seed > (UINT64_MAX - (digit - '0')) / 10){
+						details->type = R_ERR;
+						return details;
+					}
+
+					seed = seed * 10 + (digit - '0');
+					digits++;
+				}
+
+				//Throw back whatever ended the number, the null terminator included
+				current_ptr--;
+
+				if(digits > 0){
+					details->seed = seed;
+					details->has_seed = 1;
+				}
+
+				break;
+
 			//If we see this and we are in a post request, then this is our complexity value
 			case 'c':
 				//If we are not in a post request, then we don't care
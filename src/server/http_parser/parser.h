@@ -9,6 +9,8 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+//For the seed
+#include <sys/types.h>
 
 /**
  * The type of HTTP request
@@ -31,6 +33,9 @@ struct request_details{
 	request_type type;
 	int N;
 	int complexity;
+	//The seed that the start configuration should be made with, only if has_seed is 1. Otherwise the server picks one
+	u_int64_t seed;
+	int has_seed;
 };
 
 /**
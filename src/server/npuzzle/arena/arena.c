@@ -0,0 +1,139 @@
+/**
+ * Author: Jack Robbins
+ * This c file contains the implementation of the state arena that is defined in arena.h
+ */
+
+#include "arena.h"
+
+
+/**
+ * Create an arena for states of a puzzle of size N. No slabs are reserved until the first allocation
+ */
+struct state_arena* initialize_arena(const int N){
+	struct state_arena* arena = (struct state_arena*)malloc(sizeof(struct state_arena));
+
+	arena->N = N;
+
+	//Packed states have no tiles at all, and the smallest leave off the high half of the word too. The rest keep
+	//their tiles right after the state header. Round up to a multiple of the state's alignment so that every block
+	//in a slab is aligned
+	arena->block_size = (state_size(N) + _Alignof(struct state) - 1) & ~(_Alignof(struct state) - 1);
+
+	//Everything else starts out empty
+	arena->slabs = NULL;
+	arena->bump = NULL;
+	arena->bump_end = NULL;
+	arena->free_list = NULL;
+	arena->bytes_reserved = 0;
+
+	return arena;
+}
+
+
+/**
+ * Reserve a new slab and point the bump pointer at it
+ */
+static void arena_new_slab(struct state_arena* arena){
+	//The slab header is padded out to one block so that the first block stays aligned
+	size_t header_size = (sizeof(struct slab) + _Alignof(struct state) - 1) & ~(_Alignof(struct state) - 1);
+	size_t slab_size = header_size + arena->block_size * STATES_PER_SLAB;
+
+	struct slab* slab = (struct slab*)aligned_alloc(_Alignof(struct state), slab_size);
+
+	//Link it in so that destroy_arena can find it
+	slab->next = arena->slabs;
+	arena->slabs = slab;
+
+	//Blocks are carved out from right after the header
+	arena->bump = (char*)slab + header_size;
+	arena->bump_end = arena->bump + arena->block_size * STATES_PER_SLAB;
+	arena->bytes_reserved += slab_size;
+}
+
+
+/**
+ * Allocate a state out of the arena. Released states are reused first, otherwise the block comes off of
+ * the bump pointer
+ */
+struct state* arena_allocate_state(struct state_arena* arena){
+	struct state* state_ptr;
+
+	//Reuse a released state if we have one
+	if(arena->free_list != NULL){
+		state_ptr = arena->free_list;
+		arena->free_list = state_ptr->next;
+	} else {
+		//If the current slab is used up, grab another one
+		if(arena->bump == arena->bump_end){
+			arena_new_slab(arena);
+		}
+
+		state_ptr = (struct state*)arena->bump;
+		arena->bump += arena->block_size;
+	}
+
+	//The tiles live right after the header, unless this is a packed state. Only the 5x5 has the high half of the word
+	if(arena->N <= PACKED_SMALL_MAX_N){
+		state_ptr->packed = 0;
+	} else if(arena->N <= PACKED_MAX_N){
+		state_ptr->packed = 0;
+		state_ptr->packed_high = 0;
+	} else {
+		state_ptr->tiles = (short*)(state_ptr + 1);
+	}
+
+	state_ptr->predecessor = NULL;
+	state_ptr->next = NULL;
+
+	return state_ptr;
+}
+
+
+/**
+ * Give a state back to the arena by pushing it onto the free list
+ */
+void arena_release_state(struct state_arena* arena, struct state* state_ptr){
+	state_ptr->next = arena->free_list;
+	arena->free_list = state_ptr;
+}
+
+
+/**
+ * Take over every slab of other, then release other itself. The states in other stay exactly where they are,
+ * and are released along with arena from here on out
+ */
+void arena_adopt(struct state_arena* arena, struct state_arena* other){
+	//If other never allocated anything, there's nothing to take
+	if(other->slabs != NULL){
+		//Find the end of other's slabs, and put all of ours after it
+		struct slab* tail = other->slabs;
+		while(tail->next != NULL){
+			tail = tail->next;
+		}
+
+		tail->next = arena->slabs;
+		arena->slabs = other->slabs;
+		arena->bytes_reserved += other->bytes_reserved;
+	}
+
+	//The free list and the bump pointer of other are simply dropped
+	free(other);
+}
+
+
+/**
+ * Release every slab, and with them every state, then the arena itself
+ */
+void destroy_arena(struct state_arena* arena){
+	struct slab* cursor = arena->slabs;
+	struct slab* temp;
+
+	//Walk the list of slabs
+	while(cursor != NULL){
+		temp = cursor;
+		cursor = cursor->next;
+		free(temp);
+	}
+
+	free(arena);
+}
@@ -0,0 +1,70 @@
+/**
+ * Author: Jack Robbins
+ * This header file defines the state arena, a per-solve memory pool that hands out states from large
+ * contiguous slabs. The functions are implemented in arena.c
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+//How many states we carve out of every slab
+#define STATES_PER_SLAB 8192
+
+#include "../puzzle/puzzle.h"
+
+/**
+ * A slab is one large allocation that states are carved out of. Slabs are kept in a linked list so
+ * that they can all be released at once
+ */
+struct slab {
+	struct slab* next;
+};
+
+
+/**
+ * The arena itself. Every solve gets its own arena, so there is never any contention between concurrent
+ * solves, and since only the solver's main thread allocates from it, the arena needs no lock at all
+ */
+struct state_arena {
+	//The size of the puzzle that this arena is for
+	int N;
+	//The size of one block, the state header followed by its tiles, rounded up for alignment
+	size_t block_size;
+	//All of the slabs that we've allocated so far
+	struct slab* slabs;
+	//The bump pointer into the current slab, and the end of that slab
+	char* bump;
+	char* bump_end;
+	//States that have been released, linked together through their next pointer
+	struct state* free_list;
+	//How many bytes the arena has reserved in total
+	size_t bytes_reserved;
+};
+
+
+/**
+ * Create an arena for states of a puzzle of size N
+ */
+struct state_arena* initialize_arena(const int N);
+
+/**
+ * Allocate a state out of the arena. The state is ready to use, exactly as if it had been through initialize_state
+ */
+struct state* arena_allocate_state(struct state_arena* arena);
+
+/**
+ * Give a state back to the arena so that its block can be reused by the next allocation
+ */
+void arena_release_state(struct state_arena* arena, struct state* state_ptr);
+
+/**
+ * Move every state in other into arena, so that they are all released together, and destroy other
+ */
+void arena_adopt(struct state_arena* arena, struct state_arena* other);
+
+/**
+ * Release every state in the arena, and the arena itself, in one operation
+ */
+void destroy_arena(struct state_arena* arena);
+
+#endif /* ARENA_H */
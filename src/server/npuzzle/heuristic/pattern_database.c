@@ -0,0 +1,404 @@
+/**
+ * Author: Jack Robbins
+ * This file contains the implementation of the additive 6-6-3 pattern database for the 4x4 puzzle.
+ *
+ * The 15 tiles are split into three disjoint groups. For every group, the table holds the smallest number of
+ * moves of that group's own tiles needed to bring them home from any placement, where moves of all other tiles
+ * are free. Since no move is ever counted by two groups, the three values can be added together and the sum is
+ * still admissible. The solver does not count on it being consistent, so a closed state that turns up again by a
+ * cheaper path is reopened by check_repeating_closed and merge_to_closed, and that has to stay. The tables are
+ * indexed by the ranked positions of the group's tiles, so the blank does not take up any space in them
+ */
+
+#include "pattern_database.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//The number of cells on the 4x4 board
+#define CELLS 16
+//An unreached entry in a table that is being built
+#define UNREACHED 0xFF
+
+/**
+ * The tile groups. The two groups of 6 cover the left and right halves of the board below the top row,
+ * and the group of 3 covers what is left of the top row
+ */
+static const int num_groups = 3;
+static const int group_sizes[3] = {6, 6, 3};
+static const short group_tiles[3][6] = {
+	{1, 5, 6, 9, 10, 13},
+	{7, 8, 11, 12, 14, 15},
+	{2, 3, 4, 0, 0, 0}
+};
+
+//The mapped file, and the tables inside of it. Everything is read only once loaded
+static void* database_map = NULL;
+static size_t database_map_size = 0;
+static const unsigned char* tables[3] = {NULL, NULL, NULL};
+
+
+/**
+ * The number of entries in the table of a group with the given size, which is 16!/(16 - size)!
+ */
+static u_int64_t table_size(const int size){
+	u_int64_t entries = 1;
+
+	for(int i = 0; i < size; i++){
+		entries *= CELLS - i;
+	}
+
+	return entries;
+}
+
+
+/**
+ * Rank the ordered cells that a group of tiles sits on. Every tile's digit is its cell's place among the
+ * cells that are not taken by the tiles before it, which gives a dense index with no gaps
+ */
+static u_int32_t rank_positions(const unsigned char* positions, const int size){
+	u_int32_t rank = 0;
+
+	for(int i = 0; i < size; i++){
+		//Count how many of the earlier tiles sit on a smaller cell
+		int smaller = 0;
+		for(int j = 0; j < i; j++){
+			if(positions[j] < positions[i]){
+				smaller++;
+			}
+		}
+		rank = rank * (CELLS - i) + (positions[i] - smaller);
+	}
+
+	return rank;
+}
+
+
+/**
+ * The inverse of rank_positions, used by the builder to get the cells back out of a table index
+ */
+static void unrank_positions(u_int32_t rank, unsigned char* positions, const int size){
+	int digits[PATTERN_DATABASE_MAX_GROUP_SIZE];
+
+	//Peel the digits off from the last tile to the first
+	for(int i = size - 1; i >= 0; i--){
+		digits[i] = rank % (CELLS - i);
+		rank /= CELLS - i;
+	}
+
+	//Every digit picks the n-th cell that has not been taken yet
+	int taken = 0;
+	for(int i = 0; i < size; i++){
+		int cell = 0;
+		for(int remaining = digits[i]; ; cell++){
+			if(!(taken & (1 << cell)) && remaining-- == 0){
+				break;
+			}
+		}
+		positions[i] = cell;
+		taken |= 1 << cell;
+	}
+}
+
+
+/**
+ * Build the table for one group with a retrograde breadth first search from the goal. The abstract states
+ * are the cells of the group's tiles plus the region of free cells that the blank can wander around in
+ * without moving one of the group's tiles. Wandering is free, so every level of the search floods the
+ * blank's region, and then tries every move of a group tile into that region, which costs one
+ */
+static unsigned char* build_group_table(const short* tiles, const int size){
+	u_int64_t entries = table_size(size);
+
+	//The table starts out all unreached
+	unsigned char* table = malloc(entries);
+	memset(table, UNREACHED, entries);
+
+	//One visited bit for every combination of a rank and a blank cell
+	u_int64_t* visited = calloc((entries * CELLS + 63) / 64, sizeof(u_int64_t));
+
+	//The current and next levels, stored as the rank shifted up next to the blank cell
+	u_int64_t current_max = 1024, next_max = 1024;
+	u_int64_t current_size = 0, next_size = 0;
+	u_int32_t* current = malloc(current_max * sizeof(u_int32_t));
+	u_int32_t* next = malloc(next_max * sizeof(u_int32_t));
+
+	//Seed the search with the goal, where every tile is home and the blank is in the bottom right corner
+	unsigned char positions[PATTERN_DATABASE_MAX_GROUP_SIZE];
+	for(int i = 0; i < size; i++){
+		positions[i] = tiles[i] - 1;
+	}
+	u_int64_t seed = (u_int64_t)rank_positions(positions, size) * CELLS + (CELLS - 1);
+	visited[seed / 64] |= 1ULL << (seed % 64);
+	current[current_size++] = seed;
+
+	for(int level = 0; current_size > 0; level++){
+		for(u_int64_t e = 0; e < current_size; e++){
+			u_int32_t rank = current[e] / CELLS;
+			int blank = current[e] % CELLS;
+
+			//The first time that we see a rank is the cheapest that it can be
+			if(table[rank] == UNREACHED){
+				table[rank] = level;
+			}
+
+			unrank_positions(rank, positions, size);
+
+			//Which cells hold a group tile, and which tile it is
+			int owner[CELLS];
+			int occupied = 0;
+			for(int i = 0; i < CELLS; i++){
+				owner[i] = -1;
+			}
+			for(int i = 0; i < size; i++){
+				owner[positions[i]] = i;
+				occupied |= 1 << positions[i];
+			}
+
+			//Flood the region that the blank can reach for free, marking all of it as visited
+			int region = 1 << blank;
+			int stack[CELLS];
+			int stack_size = 0;
+			stack[stack_size++] = blank;
+			while(stack_size > 0){
+				int cell = stack[--stack_size];
+				u_int64_t bit = (u_int64_t)rank * CELLS + cell;
+				visited[bit / 64] |= 1ULL << (bit % 64);
+
+				int row = cell / PATTERN_DATABASE_N, column = cell % PATTERN_DATABASE_N;
+				int neighbours[4] = {row > 0 ? cell - 4 : -1, row < 3 ? cell + 4 : -1, column > 0 ? cell - 1 : -1, column < 3 ? cell + 1 : -1};
+				for(int n = 0; n < 4; n++){
+					int neighbour = neighbours[n];
+					if(neighbour >= 0 && !(occupied & (1 << neighbour)) && !(region & (1 << neighbour))){
+						region |= 1 << neighbour;
+						stack[stack_size++] = neighbour;
+					}
+				}
+			}
+
+			//Now try sliding every group tile that borders the region into it
+			for(int cell = 0; cell < CELLS; cell++){
+				if(!(region & (1 << cell))){
+					continue;
+				}
+
+				int row = cell / PATTERN_DATABASE_N, column = cell % PATTERN_DATABASE_N;
+				int neighbours[4] = {row > 0 ? cell - 4 : -1, row < 3 ? cell + 4 : -1, column > 0 ? cell - 1 : -1, column < 3 ? cell + 1 : -1};
+				for(int n = 0; n < 4; n++){
+					int neighbour = neighbours[n];
+					if(neighbour < 0 || owner[neighbour] < 0){
+						continue;
+					}
+
+					//The tile moves into the region, and the blank takes its old cell
+					int tile = owner[neighbour];
+					positions[tile] = cell;
+					u_int64_t bit = (u_int64_t)rank_positions(positions, size) * CELLS + neighbour;
+					positions[tile] = neighbour;
+
+					if(visited[bit / 64] & (1ULL << (bit % 64))){
+						continue;
+					}
+					visited[bit / 64] |= 1ULL << (bit % 64);
+
+					//Grow the next level if we need to
+					if(next_size == next_max){
+						next_max *= 2;
+						next = realloc(next, next_max * sizeof(u_int32_t));
+					}
+					next[next_size++] = bit;
+				}
+			}
+		}
+
+		//The next level becomes the current one
+		u_int32_t* temp = current;
+		current = next;
+		next = temp;
+		u_int64_t temp_max = current_max;
+		current_max = next_max;
+		next_max = temp_max;
+		current_size = next_size;
+		next_size = 0;
+	}
+
+	free(current);
+	free(next);
+	free(visited);
+
+	return table;
+}
+
+
+/**
+ * Build every group's table and write the file out, header first
+ */
+int build_pattern_database(const char* filename){
+	struct pattern_database_header header;
+	memset(&header, 0, sizeof(struct pattern_database_header));
+
+	//Fill in the header
+	memcpy(header.magic, "NPZPDB", 6);
+	header.version = PATTERN_DATABASE_VERSION;
+	header.N = PATTERN_DATABASE_N;
+	header.num_groups = num_groups;
+
+	u_int64_t offset = sizeof(struct pattern_database_header);
+	for(int g = 0; g < num_groups; g++){
+		header.group_sizes[g] = group_sizes[g];
+		for(int i = 0; i < group_sizes[g]; i++){
+			header.group_tiles[g][i] = group_tiles[g][i];
+		}
+		header.table_offsets[g] = offset;
+		offset += table_size(group_sizes[g]);
+	}
+	header.file_size = offset;
+
+	FILE* file = fopen(filename, "wb");
+	if(file == NULL){
+		printf("ERROR: Could not open %s for writing.\n", filename);
+		return -1;
+	}
+
+	if(fwrite(&header, sizeof(struct pattern_database_header), 1, file) != 1){
+		fclose(file);
+		return -1;
+	}
+
+	//Build and write the tables one at a time, so only one is ever held in memory
+	for(int g = 0; g < num_groups; g++){
+		printf("Building the pattern database table for group %d of %d...\n", g + 1, num_groups);
+		unsigned char* table = build_group_table(group_tiles[g], group_sizes[g]);
+
+		size_t written = fwrite(table, 1, table_size(group_sizes[g]), file);
+		free(table);
+
+		if(written != table_size(group_sizes[g])){
+			fclose(file);
+			return -1;
+		}
+	}
+
+	if(fclose(file) != 0){
+		return -1;
+	}
+
+	printf("Pattern database written to %s (%lu bytes).\n", filename, (unsigned long)header.file_size);
+
+	return 0;
+}
+
+
+/**
+ * Map the file in and make sure that it is one that we built, with the same groups that this code looks up
+ */
+int load_pattern_database(const char* filename){
+	//If we already have one, there's nothing to do
+	if(database_map != NULL){
+		return 0;
+	}
+
+	int fd = open(filename, O_RDONLY);
+	if(fd < 0){
+		return -1;
+	}
+
+	struct stat file_stats;
+	if(fstat(fd, &file_stats) != 0 || (size_t)file_stats.st_size < sizeof(struct pattern_database_header)){
+		close(fd);
+		return -1;
+	}
+
+	//Every solver thread reads the same pages, so there is only ever one copy in memory
+	void* map = mmap(NULL, file_stats.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	//The mapping holds its own reference to the file
+	close(fd);
+	if(map == MAP_FAILED){
+		return -1;
+	}
+
+	const struct pattern_database_header* header = map;
+
+	//Check that the header agrees with the groups that we were compiled with
+	int valid = memcmp(header->magic, "NPZPDB", 6) == 0 && header->version == PATTERN_DATABASE_VERSION
+				&& header->N == PATTERN_DATABASE_N && header->num_groups == (u_int32_t)num_groups
+				&& header->file_size == (u_int64_t)file_stats.st_size;
+
+	for(int g = 0; valid && g < num_groups; g++){
+		valid = header->group_sizes[g] == (u_int32_t)group_sizes[g]
+				&& header->table_offsets[g] + table_size(group_sizes[g]) <= header->file_size;
+		for(int i = 0; valid && i < group_sizes[g]; i++){
+			valid = header->group_tiles[g][i] == (u_int32_t)group_tiles[g][i];
+		}
+	}
+
+	if(!valid){
+		printf("ERROR: %s is not a valid pattern database, ignoring it.\n", filename);
+		munmap(map, file_stats.st_size);
+		return -1;
+	}
+
+	for(int g = 0; g < num_groups; g++){
+		tables[g] = (const unsigned char*)map + header->table_offsets[g];
+	}
+	database_map_size = file_stats.st_size;
+	database_map = map;
+
+	return 0;
+}
+
+
+/**
+ * Returns 1 if we have a pattern database to look things up in
+ */
+int pattern_database_loaded(void){
+	return database_map != NULL;
+}
+
+
+/**
+ * Add up every group's table value, given the cell that every tile sits on
+ */
+static int additive_cost(const unsigned char* cell_of_tile){
+	int cost = 0;
+	unsigned char positions[PATTERN_DATABASE_MAX_GROUP_SIZE];
+
+	for(int g = 0; g < num_groups; g++){
+		for(int i = 0; i < group_sizes[g]; i++){
+			positions[i] = cell_of_tile[group_tiles[g][i]];
+		}
+		cost += tables[g][rank_positions(positions, group_sizes[g])];
+	}
+
+	return cost;
+}
+
+
+/**
+ * Look up the heuristic for a state. The reflection along the main diagonal is a different state with the
+ * same distance to the goal, since tile t at (row, column) becomes the tile whose goal is t's goal mirrored, at
+ * (column, row). Its groups line up differently, so it often gives a better bound for free
+ */
+int pattern_database_cost(struct state* statePtr){
+	unsigned char cell_of_tile[CELLS];
+	unsigned char reflected_cell_of_tile[CELLS];
+
+	//Find where every tile is
+	for(int cell = 0; cell < CELLS; cell++){
+		cell_of_tile[get_tile(statePtr, cell, PATTERN_DATABASE_N)] = cell;
+	}
+
+	//Mirror every tile and the cell it sits on
+	for(int tile = 1; tile < CELLS; tile++){
+		int goal = tile - 1;
+		int mirrored_tile = (goal % PATTERN_DATABASE_N) * PATTERN_DATABASE_N + goal / PATTERN_DATABASE_N + 1;
+		int cell = cell_of_tile[tile];
+		reflected_cell_of_tile[mirrored_tile] = (cell % PATTERN_DATABASE_N) * PATTERN_DATABASE_N + cell / PATTERN_DATABASE_N;
+	}
+
+	int cost = additive_cost(cell_of_tile);
+	int reflected_cost = additive_cost(reflected_cell_of_tile);
+
+	return cost > reflected_cost ? cost : reflected_cost;
+}
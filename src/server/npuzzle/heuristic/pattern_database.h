@@ -0,0 +1,64 @@
+/**
+ * Author: Jack Robbins
+ * This header file defines the additive pattern database heuristic for the 4x4 puzzle. The database
+ * is built once into a binary file, and then mapped read-only into memory at startup so that every
+ * solver thread shares the same copy. The functions are implemented in pattern_database.c
+ */
+
+#ifndef PATTERN_DATABASE_H
+#define PATTERN_DATABASE_H
+
+//The file that the pattern database is built into and loaded from
+#define PATTERN_DATABASE_FILE "pattern_database_4x4.bin"
+//The pattern database only exists for the 4x4 puzzle
+#define PATTERN_DATABASE_N 4
+//Bump this whenever the file layout or the tile groups change
+#define PATTERN_DATABASE_VERSION 1
+//The most groups and the most tiles in one group that the file can describe
+#define PATTERN_DATABASE_MAX_GROUPS 4
+#define PATTERN_DATABASE_MAX_GROUP_SIZE 8
+
+#include "../puzzle/puzzle.h"
+
+/**
+ * The header at the very start of the pattern database file. Everything after it is the tables
+ */
+struct pattern_database_header {
+	//Always "NPZPDB" followed by two null characters
+	char magic[8];
+	u_int32_t version;
+	u_int32_t N;
+	u_int32_t num_groups;
+	u_int32_t group_sizes[PATTERN_DATABASE_MAX_GROUPS];
+	u_int32_t group_tiles[PATTERN_DATABASE_MAX_GROUPS][PATTERN_DATABASE_MAX_GROUP_SIZE];
+	//Where every group's table starts, counted from the start of the file
+	u_int64_t table_offsets[PATTERN_DATABASE_MAX_GROUPS];
+	//The size that the whole file must be
+	u_int64_t file_size;
+};
+
+
+/**
+ * Run a retrograde breadth first search for every tile group, and write the resulting tables out to filename.
+ * Returns 0 on success and -1 on failure
+ */
+int build_pattern_database(const char* filename);
+
+/**
+ * Map the pattern database in filename into memory, read only, after validating it. Returns 0 on success
+ * and -1 if the file is missing or invalid, in which case the pattern database simply stays unavailable
+ */
+int load_pattern_database(const char* filename);
+
+/**
+ * Returns 1 if a pattern database has been loaded, 0 otherwise
+ */
+int pattern_database_loaded(void);
+
+/**
+ * Look up the pattern database heuristic for a 4x4 state. This is the larger of the additive value for the
+ * state itself and for its reflection along the main diagonal
+ */
+int pattern_database_cost(struct state* state_ptr);
+
+#endif /* PATTERN_DATABASE_H */
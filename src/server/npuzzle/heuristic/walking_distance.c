@@ -0,0 +1,535 @@
+/**
+ * Author: Jack Robbins
+ * This file contains the implementation of the walking distance heuristic for the 4x4 and 5x5 puzzles.
+ *
+ * Walking distance looks at the rows and the columns of the puzzle separately. For the rows, it only keeps track of
+ * how many tiles from every goal row are in every row, and which row the blank is in. A vertical move takes one
+ * tile out of the row next to the blank and puts it into the blank's row, so a breadth first search over these
+ * patterns gives the fewest vertical moves needed to get every tile into its goal row. The same goes for columns
+ * and horizontal moves, and since no move is both, the two can be added together. This is always at least the
+ * manhattan distance, and usually well above linear conflicts too
+ */
+
+#include "walking_distance.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//The bits used by every count in an encoded pattern
+#define COUNT_BITS 3
+#define COUNT_MASK 7
+
+//The tables for every N that we have, NULL if we don't have one
+static struct walking_distance_table* tables[WALKING_DISTANCE_MAX_N + 1];
+
+/**
+ * The table while it is being built. The patterns are kept in breadth first order, so the array doubles as the
+ * queue, and an open addressing index is used to find out if a pattern has been seen before
+ */
+struct table_builder {
+	int N;
+	int num_patterns;
+	int max_patterns;
+	u_int64_t* patterns;
+	unsigned char* distances;
+	//An empty slot is -1
+	int* index;
+	//How many slots the index has, always a power of 2
+	int index_size;
+};
+
+
+/**
+ * The key of one pattern and its distance, for sorting the table once it's built
+ */
+struct key_distance {
+	u_int64_t key;
+	unsigned char distance;
+};
+
+
+/**
+ * The bit offset of the count for tiles of goal line tile_class in the given line
+ */
+static int count_offset(const int N, const int line, const int tile_class){
+	return COUNT_BITS * (line * (N - 1) + tile_class);
+}
+
+
+/**
+ * The bit offset of the line that the blank is in
+ */
+static int blank_offset(const int N){
+	return COUNT_BITS * N * (N - 1);
+}
+
+
+/**
+ * Get the number of tiles of goal line tile_class that are in the given line of an encoded pattern
+ */
+static int get_count(const int N, const u_int64_t pattern, const int line, const int tile_class){
+	//The last class isn't stored, it's whatever is left of the line
+	if(tile_class == N - 1){
+		int blank_line = (pattern >> blank_offset(N)) & COUNT_MASK;
+		int count = line == blank_line ? N - 1 : N;
+
+		for(int i = 0; i < N - 1; i++){
+			count -= (pattern >> count_offset(N, line, i)) & COUNT_MASK;
+		}
+
+		return count;
+	}
+
+	return (pattern >> count_offset(N, line, tile_class)) & COUNT_MASK;
+}
+
+
+/**
+ * Move a tile of goal line tile_class from from_line into to_line, where the blank is, which leaves the blank in
+ * from_line. Returns the new encoded pattern
+ */
+static u_int64_t move_tile(const int N, u_int64_t pattern, const int from_line, const int to_line, const int tile_class){
+	//The last class follows from where the blank is, so only the stored classes need their counts moved
+	if(tile_class != N - 1){
+		pattern -= (u_int64_t)1 << count_offset(N, from_line, tile_class);
+		pattern += (u_int64_t)1 << count_offset(N, to_line, tile_class);
+	}
+
+	//Now put the blank into from_line
+	pattern &= ~((u_int64_t)COUNT_MASK << blank_offset(N));
+	pattern |= (u_int64_t)from_line << blank_offset(N);
+
+	return pattern;
+}
+
+
+/**
+ * Spread the bits of an encoded pattern around. Every step can be undone, so no two patterns share a result, which
+ * makes it both the hash for the builder's index and the key that the finished table is sorted by
+ */
+static u_int64_t mix_pattern(u_int64_t pattern){
+	pattern ^= pattern >> 33;
+	pattern *= 0xff51afd7ed558ccdULL;
+	pattern ^= pattern >> 33;
+	pattern *= 0xc4ceb9fe1a85ec53ULL;
+	pattern ^= pattern >> 33;
+
+	return pattern;
+}
+
+
+/**
+ * Put the pattern at the given position into the builder's index. The index must have room for it
+ */
+static void index_pattern(struct table_builder* builder, const int position){
+	u_int64_t mask = builder->index_size - 1;
+	u_int64_t slot = mix_pattern(builder->patterns[position]) & mask;
+
+	while(builder->index[slot] != -1){
+		slot = (slot + 1) & mask;
+	}
+
+	builder->index[slot] = position;
+}
+
+
+/**
+ * Returns 1 if the builder has already seen a pattern, 0 otherwise
+ */
+static int builder_contains(struct table_builder* builder, const u_int64_t pattern){
+	u_int64_t mask = builder->index_size - 1;
+	u_int64_t slot = mix_pattern(pattern) & mask;
+
+	//Linear probing until we find it or hit an empty slot
+	while(builder->index[slot] != -1){
+		if(builder->patterns[builder->index[slot]] == pattern){
+			return 1;
+		}
+
+		slot = (slot + 1) & mask;
+	}
+
+	return 0;
+}
+
+
+/**
+ * Add a pattern to the end of the builder's queue, growing everything as needed
+ */
+static void add_pattern(struct table_builder* builder, const u_int64_t pattern, const unsigned char distance){
+	if(builder->num_patterns == builder->max_patterns){
+		builder->max_patterns *= 2;
+		builder->patterns = realloc(builder->patterns, sizeof(u_int64_t) * builder->max_patterns);
+		builder->distances = realloc(builder->distances, builder->max_patterns);
+	}
+
+	builder->patterns[builder->num_patterns] = pattern;
+	builder->distances[builder->num_patterns] = distance;
+	(builder->num_patterns)++;
+
+	//Keep the index at most half full, and put everything back into it if it has to grow
+	if(2 * builder->num_patterns > builder->index_size){
+		free(builder->index);
+		builder->index_size *= 2;
+		builder->index = malloc(sizeof(int) * builder->index_size);
+		memset(builder->index, 0xFF, sizeof(int) * builder->index_size);
+
+		for(int i = 0; i < builder->num_patterns; i++){
+			index_pattern(builder, i);
+		}
+	} else {
+		index_pattern(builder, builder->num_patterns - 1);
+	}
+}
+
+
+/**
+ * Order keys for sorting
+ */
+static int compare_keys(const void* a, const void* b){
+	u_int64_t first = ((const struct key_distance*)a)->key;
+	u_int64_t second = ((const struct key_distance*)b)->key;
+
+	return first < second ? -1 : first > second;
+}
+
+
+/**
+ * Build the table for N with a breadth first search from the goal pattern, then sort it by key and fill in its
+ * directory. The table lives in memory, with map set to NULL
+ */
+static struct walking_distance_table* build_table(const int N){
+	struct table_builder builder;
+
+	builder.N = N;
+	builder.num_patterns = 0;
+	builder.max_patterns = 1024;
+	builder.patterns = malloc(sizeof(u_int64_t) * builder.max_patterns);
+	builder.distances = malloc(builder.max_patterns);
+	builder.index_size = 2048;
+	builder.index = malloc(sizeof(int) * builder.index_size);
+	memset(builder.index, 0xFF, sizeof(int) * builder.index_size);
+
+	//In the goal, every line holds all of its own tiles, and the blank is in the last line
+	u_int64_t goal = (u_int64_t)(N - 1) << blank_offset(N);
+	for(int line = 0; line < N - 1; line++){
+		goal |= (u_int64_t)N << count_offset(N, line, line);
+	}
+	add_pattern(&builder, goal, 0);
+
+	for(int i = 0; i < builder.num_patterns; i++){
+		u_int64_t pattern = builder.patterns[i];
+		int blank_line = (pattern >> blank_offset(N)) & COUNT_MASK;
+
+		//Any tile in the lines above and below the blank can move into the blank's line
+		for(int from_line = blank_line - 1; from_line <= blank_line + 1; from_line += 2){
+			if(from_line < 0 || from_line >= N){
+				continue;
+			}
+
+			for(int tile_class = 0; tile_class < N; tile_class++){
+				if(get_count(N, pattern, from_line, tile_class) == 0){
+					continue;
+				}
+
+				u_int64_t moved = move_tile(N, pattern, from_line, blank_line, tile_class);
+
+				if(builder_contains(&builder, moved) == 0){
+					add_pattern(&builder, moved, builder.distances[i] + 1);
+				}
+			}
+		}
+	}
+
+	//The index is only needed while building
+	free(builder.index);
+
+	//Sort by key, keeping every distance with its key
+	struct key_distance* sorted = malloc(sizeof(struct key_distance) * builder.num_patterns);
+	for(int i = 0; i < builder.num_patterns; i++){
+		sorted[i].key = mix_pattern(builder.patterns[i]);
+		sorted[i].distance = builder.distances[i];
+	}
+	free(builder.distances);
+	qsort(sorted, builder.num_patterns, sizeof(struct key_distance), compare_keys);
+
+	struct walking_distance_table* table = malloc(sizeof(struct walking_distance_table));
+	table->N = N;
+	table->num_patterns = builder.num_patterns;
+
+	//Aim for about WALKING_DISTANCE_DIRECTORY_SPAN keys per directory entry, but never use fewer bits than an entry drops
+	table->directory_bits = WALKING_DISTANCE_DISTANCE_BITS;
+	while(((long)WALKING_DISTANCE_DIRECTORY_SPAN << table->directory_bits) < table->num_patterns){
+		(table->directory_bits)++;
+	}
+
+	int directory_size = (1 << table->directory_bits) + 1;
+	u_int32_t* directory = malloc(sizeof(u_int32_t) * directory_size);
+	//The patterns array is reused for the finished entries
+	u_int64_t* entries = builder.patterns;
+
+	//One pass over the sorted keys packs every entry and finds where every directory entry begins
+	int position = 0;
+	for(int i = 0; i < directory_size; i++){
+		while(position < table->num_patterns && (int)(sorted[position].key >> (64 - table->directory_bits)) < i){
+			entries[position] = (sorted[position].key << WALKING_DISTANCE_DISTANCE_BITS) | sorted[position].distance;
+			position++;
+		}
+		directory[i] = position;
+	}
+	free(sorted);
+
+	table->directory = directory;
+	table->entries = entries;
+	table->map = NULL;
+	table->map_size = 0;
+
+	return table;
+}
+
+
+/**
+ * Free a table that build_table made
+ */
+static void destroy_table(struct walking_distance_table* table){
+	free((void*)(table->directory));
+	free((void*)(table->entries));
+	free(table);
+}
+
+
+/**
+ * Build the table for N and write it out to its cache file
+ */
+int build_walking_distance(const int N){
+	if(N < WALKING_DISTANCE_MIN_N || N > WALKING_DISTANCE_MAX_N){
+		return -1;
+	}
+
+	char filename[64];
+	sprintf(filename, WALKING_DISTANCE_FILE_FORMAT, N, N);
+
+	struct walking_distance_table* table = build_table(N);
+	int directory_size = (1 << table->directory_bits) + 1;
+
+	struct walking_distance_header header;
+	memset(&header, 0, sizeof(struct walking_distance_header));
+	memcpy(header.magic, "NPZWD", 5);
+	header.version = WALKING_DISTANCE_VERSION;
+	header.N = N;
+	header.directory_bits = table->directory_bits;
+	header.num_patterns = table->num_patterns;
+
+	FILE* file = fopen(filename, "wb");
+	int result = -1;
+
+	if(file != NULL){
+		if(fwrite(&header, sizeof(struct walking_distance_header), 1, file) == 1
+		   && fwrite(table->entries, sizeof(u_int64_t), table->num_patterns, file) == (size_t)table->num_patterns
+		   && fwrite(table->directory, sizeof(u_int32_t), directory_size, file) == (size_t)directory_size){
+			result = 0;
+		}
+
+		if(fclose(file) != 0){
+			result = -1;
+		}
+	}
+
+	if(result == 0){
+		printf("Walking distance table written to %s (%d patterns).\n", filename, table->num_patterns);
+	} else {
+		printf("ERROR: Could not write %s.\n", filename);
+	}
+
+	destroy_table(table);
+
+	return result;
+}
+
+
+/**
+ * Map a cached table file in, returning NULL if it is missing or isn't a table for N
+ */
+static struct walking_distance_table* map_table(const char* filename, const int N){
+	int fd = open(filename, O_RDONLY);
+	if(fd < 0){
+		return NULL;
+	}
+
+	struct stat file_stats;
+	if(fstat(fd, &file_stats) != 0 || (size_t)file_stats.st_size < sizeof(struct walking_distance_header)){
+		close(fd);
+		return NULL;
+	}
+
+	void* map = mmap(NULL, file_stats.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	//The mapping holds its own reference to the file
+	close(fd);
+	if(map == MAP_FAILED){
+		return NULL;
+	}
+
+	const struct walking_distance_header* header = map;
+	size_t directory_size = ((size_t)1 << header->directory_bits) + 1;
+
+	//Make sure that this is a table for N, and that it's all there
+	if(memcmp(header->magic, "NPZWD", 5) != 0 || header->version != WALKING_DISTANCE_VERSION || header->N != (u_int32_t)N
+	   || header->directory_bits < WALKING_DISTANCE_DISTANCE_BITS || header->directory_bits > 30
+	   || (size_t)file_stats.st_size != sizeof(struct walking_distance_header) + directory_size * sizeof(u_int32_t)
+										+ header->num_patterns * sizeof(u_int64_t)){
+		munmap(map, file_stats.st_size);
+		return NULL;
+	}
+
+	struct walking_distance_table* table = malloc(sizeof(struct walking_distance_table));
+	table->N = N;
+	table->num_patterns = header->num_patterns;
+	table->directory_bits = header->directory_bits;
+	//The entries come first, so that they stay 8 byte aligned
+	table->entries = (const u_int64_t*)(header + 1);
+	table->directory = (const u_int32_t*)(table->entries + table->num_patterns);
+	table->map = map;
+	table->map_size = file_stats.st_size;
+
+	return table;
+}
+
+
+/**
+ * Get the table for N ready, from its cached file if we can. The 4x4 table can be built on the spot if need be, and
+ * it's only written out for the next process if we were asked to
+ */
+int initialize_walking_distance(const int N, const int write_cache){
+	if(N < WALKING_DISTANCE_MIN_N || N > WALKING_DISTANCE_MAX_N){
+		return -1;
+	}
+
+	//We already have it
+	if(tables[N] != NULL){
+		return 0;
+	}
+
+	char filename[64];
+	sprintf(filename, WALKING_DISTANCE_FILE_FORMAT, N, N);
+
+	struct walking_distance_table* table = map_table(filename, N);
+
+	//The larger tables take far too long to build on every startup
+	if(table == NULL && N <= WALKING_DISTANCE_BUILD_MAX_N){
+		//Cache it for the next process, and use the cached copy so that it's shared like any other
+		if(write_cache == 1 && build_walking_distance(N) == 0){
+			table = map_table(filename, N);
+		}
+
+		//If we couldn't or shouldn't write the cache, just keep what we build in memory
+		if(table == NULL){
+			table = build_table(N);
+		}
+	}
+
+	if(table == NULL){
+		return -1;
+	}
+
+	tables[N] = table;
+
+	return 0;
+}
+
+
+/**
+ * Returns 1 if the table for N is ready
+ */
+int walking_distance_loaded(const int N){
+	return N >= WALKING_DISTANCE_MIN_N && N <= WALKING_DISTANCE_MAX_N && tables[N] != NULL;
+}
+
+
+/**
+ * Look up how many moves an encoded pattern needs. The directory gives the few entries that its key could be among,
+ * and a binary search finds it from there. Every pattern that a real state can have is in the table
+ */
+static int lookup_distance(const struct walking_distance_table* table, const u_int64_t pattern){
+	u_int64_t key = mix_pattern(pattern);
+
+	u_int64_t directory_entry = key >> (64 - table->directory_bits);
+	//The bits that an entry drops are all in the part of the key that the directory already matched
+	u_int64_t wanted = key << WALKING_DISTANCE_DISTANCE_BITS;
+	int low = table->directory[directory_entry];
+	int high = table->directory[directory_entry + 1] - 1;
+
+	while(low < high){
+		int middle = low + (high - low) / 2;
+
+		if(table->entries[middle] < wanted){
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+
+	return table->entries[low] & ((1 << WALKING_DISTANCE_DISTANCE_BITS) - 1);
+}
+
+
+/**
+ * Work out the row and column patterns of a state, and how many moves each one needs. A vertical move only changes
+ * the row pattern and a horizontal move only changes the column pattern, so with a predecessor we only need to move
+ * one tile in one of them, and look up just that one
+ */
+void update_walking_distance(struct state* statePtr, const int N){
+	struct walking_distance_table* table = tables[N];
+	struct state* predecessor = statePtr->predecessor;
+
+	if(predecessor != NULL){
+		statePtr->walking_rows = predecessor->walking_rows;
+		statePtr->walking_columns = predecessor->walking_columns;
+		statePtr->walking_row_cost = predecessor->walking_row_cost;
+		statePtr->walking_column_cost = predecessor->walking_column_cost;
+
+		//The moved tile now sits where the predecessor's blank was
+		short tile = get_tile(statePtr, predecessor->zero_row * N + predecessor->zero_column, N);
+
+		if(predecessor->zero_column == statePtr->zero_column){
+			//A vertical move, the tile left the blank's new row for its old one
+			statePtr->walking_rows = move_tile(N, statePtr->walking_rows, statePtr->zero_row, predecessor->zero_row, (tile - 1) / N);
+			statePtr->walking_row_cost = lookup_distance(table, statePtr->walking_rows);
+		} else {
+			//A horizontal move, the tile left the blank's new column for its old one
+			statePtr->walking_columns = move_tile(N, statePtr->walking_columns, statePtr->zero_column, predecessor->zero_column, (tile - 1) % N);
+			statePtr->walking_column_cost = lookup_distance(table, statePtr->walking_columns);
+		}
+
+		return;
+	}
+
+	//Without a predecessor, count up every tile
+	u_int64_t rows = (u_int64_t)statePtr->zero_row << blank_offset(N);
+	u_int64_t columns = (u_int64_t)statePtr->zero_column << blank_offset(N);
+
+	for(int i = 0; i < N * N; i++){
+		short tile = get_tile(statePtr, i, N);
+
+		//The blank, and the tiles of the last class, aren't stored
+		if(tile != 0 && (tile - 1) / N != N - 1){
+			rows += (u_int64_t)1 << count_offset(N, i / N, (tile - 1) / N);
+		}
+		if(tile != 0 && (tile - 1) % N != N - 1){
+			columns += (u_int64_t)1 << count_offset(N, i % N, (tile - 1) % N);
+		}
+	}
+
+	statePtr->walking_rows = rows;
+	statePtr->walking_columns = columns;
+	statePtr->walking_row_cost = lookup_distance(table, rows);
+	statePtr->walking_column_cost = lookup_distance(table, columns);
+}
+
+
+/**
+ * The walking distance is the vertical moves for the rows plus the horizontal moves for the columns
+ */
+int walking_distance_cost(struct state* statePtr){
+	return statePtr->walking_row_cost + statePtr->walking_column_cost;
+}
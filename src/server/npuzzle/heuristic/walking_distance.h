@@ -0,0 +1,93 @@
+/**
+ * Author: Jack Robbins
+ * This header file defines the walking distance heuristic for the 4x4 and 5x5 puzzles. The tables are built once
+ * per process, or loaded from a cached file, and are then only ever read, so every solver thread shares them. The
+ * functions are implemented in walking_distance.c
+ */
+
+#ifndef WALKING_DISTANCE_H
+#define WALKING_DISTANCE_H
+
+//The sizes of puzzle that walking distance is available for
+#define WALKING_DISTANCE_MIN_N 4
+#define WALKING_DISTANCE_MAX_N 5
+//The largest table that is quick enough to build when a process starts up, the rest must be built ahead of time
+#define WALKING_DISTANCE_BUILD_MAX_N 4
+//The cached tables are written to and read from files named like this, with N filled in twice
+#define WALKING_DISTANCE_FILE_FORMAT "walking_distance_%dx%d.bin"
+//Bump this whenever the file layout or the pattern encoding changes
+#define WALKING_DISTANCE_VERSION 1
+//How many low bits of every table entry hold the distance, walking distances never get close to 2^8
+#define WALKING_DISTANCE_DISTANCE_BITS 8
+//About how many entries every directory entry should cover
+#define WALKING_DISTANCE_DIRECTORY_SPAN 8
+
+#include "../puzzle/puzzle.h"
+
+/**
+ * A pattern is how many tiles of every goal row sit in every row, along with the row that the blank is in. Since
+ * the goal is symmetric along its diagonal, the same patterns work for columns too. Every pattern is encoded into
+ * 64 bits, 3 bits per count. The count for the last goal row is left out, since it follows from the others.
+ *
+ * The table is sorted by a key that scrambles the bits of each pattern one to one, which spreads the keys evenly,
+ * so a directory over the top bits of the key narrows every lookup down to a handful of entries. Every entry is
+ * its key shifted up, with the distance in the freed low bits, so a lookup only ever touches one array
+ */
+struct walking_distance_table {
+	int N;
+	int num_patterns;
+	//How many top bits of the key the directory covers
+	int directory_bits;
+	//Where the entries for every value of the top bits begin, with one extra at the end
+	const u_int32_t* directory;
+	const u_int64_t* entries;
+	//The mapped cache file that the arrays point into, or NULL if they were built in this process
+	void* map;
+	size_t map_size;
+};
+
+
+/**
+ * The header at the very start of a cached table file. The entries follow it, then the directory
+ */
+struct walking_distance_header {
+	//Always "NPZWD" followed by three null characters
+	char magic[8];
+	u_int32_t version;
+	u_int32_t N;
+	u_int32_t directory_bits;
+	u_int32_t reserved;
+	u_int64_t num_patterns;
+};
+
+
+/**
+ * Build the walking distance table for N with a breadth first search, and write it out to its cache file.
+ * Returns 0 on success and -1 on failure
+ */
+int build_walking_distance(const int N);
+
+/**
+ * Get the walking distance table for N ready. The cached file is mapped in read only if there is one. If not, the
+ * 4x4 table is small enough to build on the spot, and is written out to its cache file as well if write_cache is 1.
+ * The 5x5 one has tens of millions of patterns, so it is only ever built by build_walking_distance. Returns 0 on
+ * success, and -1 if walking distance isn't available for N
+ */
+int initialize_walking_distance(const int N, const int write_cache);
+
+/**
+ * Returns 1 if the walking distance table for N is ready to use, 0 otherwise
+ */
+int walking_distance_loaded(const int N);
+
+/**
+ * Work out the row and column patterns of a state. If it has a predecessor, only the tile that moved is looked at
+ */
+void update_walking_distance(struct state* state_ptr, const int N);
+
+/**
+ * The walking distance of a state that update_walking_distance has already been run on
+ */
+int walking_distance_cost(struct state* state_ptr);
+
+#endif /* WALKING_DISTANCE_H */
@@ -0,0 +1,453 @@
+/**
+ * Author: Jack Robbins
+ * This file implements move pruning. Any sequence of moves that ends up in the same place as a shorter sequence
+ * can never be part of a shortest path, so a search loses nothing by never making the last move of it. Undoing the
+ * last move is the simplest of these, but there are many more, the shortest being 7 moves around a 2x2 square,
+ * which does the same as going 5 moves the other way around.
+ *
+ * The duplicates are found once by playing out every sequence up to MOVE_PRUNING_DEPTH moves long from the middle of
+ * a board that is too big for any of them to reach its edge. A sequence is only a duplicate if the shorter one
+ * stays within the rows and columns that it does, so the shorter one can be made anywhere that it can. Only the
+ * duplicates with no shorter duplicate inside of them are kept, and those are built into an Aho-Corasick machine,
+ * as Taylor and Korf do, where a move that would finish one of them has no transition.
+ *
+ * Taylor and Korf also prune a sequence that has a duplicate of the same length. That is only safe when every path
+ * to a state is held to the one that comes first in some fixed order, which no search with a closed set or a
+ * transposition table here does, so those are left alone
+ */
+
+#include "move_pruning.h"
+#include <stdlib.h>
+#include <string.h>
+
+//The board that the sequences are played out on, with the blank starting in the middle
+#define BOARD_WIDTH (2 * MOVE_PRUNING_DEPTH + 1)
+#define BOARD_CELLS (BOARD_WIDTH * BOARD_WIDTH)
+#define BOARD_MIDDLE (MOVE_PRUNING_DEPTH * BOARD_WIDTH + MOVE_PRUNING_DEPTH)
+
+//Which way each move takes the blank, 0 = left move, 1 = right move, 2 = down move, 3 = up move
+static const int row_step[4] = {0, 0, 1, -1};
+static const int column_step[4] = {-1, 1, 0, 0};
+
+//State 0 is a path with no moves, and state 1 + m is one whose last move was m, which rules out m ^ 1
+static const u_int16_t inverse_transitions[5 * 4] = {
+	1, 2, 3, 4,
+	1, MOVE_PRUNED, 3, 4,
+	MOVE_PRUNED, 2, 3, 4,
+	1, 2, 3, MOVE_PRUNED,
+	1, 2, MOVE_PRUNED, 4
+};
+
+//Every state but the first only remembers the last move, so they all fall back to the first
+static const u_int16_t inverse_failures[5] = {0, 0, 0, 0, 0};
+
+//The inverse move machine works for every N, so it never has to be built
+static const struct move_pruning_machine inverse_machine = {0, 5, inverse_transitions, inverse_failures};
+
+//The machines for every N that has been built, N = MOVE_PRUNING_MAX_N stands in for every N above it too
+static struct move_pruning_machine* machines[MOVE_PRUNING_MAX_N + 1];
+
+
+/**
+ * A sequence of moves. The moves are kept 2 bits each, first move highest, so two sequences of the same length
+ * are the same exactly when their moves are
+ */
+struct sequence {
+	u_int32_t moves;
+	int length;
+	//The hash of the board that it ends on
+	u_int64_t hash;
+	//The rows and columns that the blank went through, inclusive
+	int top, bottom, left, right;
+};
+
+
+//Every duplicate that has no shorter duplicate inside of it, only ever found once
+static struct sequence* duplicates;
+static int num_duplicates = -1;
+
+
+/**
+ * Everything that finding the duplicates needs
+ */
+struct duplicate_finder {
+	//Every tile starts out numbered by the cell that it's in, so any two boards that match are the same arrangement
+	short board[BOARD_CELLS];
+	struct sequence* sequences;
+	int num_sequences;
+};
+
+
+/**
+ * The hash of a tile in a cell. A board's hash is all of these for its tiles, xor'd together
+ */
+static u_int64_t tile_hash(const int cell, const int tile){
+	//splitmix64 finalizer
+	u_int64_t key = (u_int64_t)cell * BOARD_CELLS + tile + 1;
+	key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+	return key ^ (key >> 31);
+}
+
+
+/**
+ * Save the sequence that got the board where it is, and then try every move that doesn't undo the last one
+ */
+static void play_sequences(struct duplicate_finder* finder, struct sequence sequence, const int blank, const int last_move){
+	finder->sequences[finder->num_sequences] = sequence;
+	(finder->num_sequences)++;
+
+	if(sequence.length == MOVE_PRUNING_DEPTH){
+		return;
+	}
+
+	for(int move = 0; move < 4; move++){
+		if(last_move >= 0 && move == (last_move ^ 1)){
+			continue;
+		}
+
+		int row = blank / BOARD_WIDTH + row_step[move];
+		int column = blank % BOARD_WIDTH + column_step[move];
+		int cell = row * BOARD_WIDTH + column;
+		short tile = finder->board[cell];
+
+		//The tile slides over into where the blank was
+		struct sequence next = sequence;
+		next.moves = (sequence.moves << 2) | move;
+		next.length = sequence.length + 1;
+		next.hash = sequence.hash ^ tile_hash(cell, tile) ^ tile_hash(blank, tile);
+		next.top = row < sequence.top ? row : sequence.top;
+		next.bottom = row > sequence.bottom ? row : sequence.bottom;
+		next.left = column < sequence.left ? column : sequence.left;
+		next.right = column > sequence.right ? column : sequence.right;
+
+		finder->board[blank] = tile;
+		finder->board[cell] = 0;
+		play_sequences(finder, next, cell, move);
+		finder->board[cell] = tile;
+		finder->board[blank] = 0;
+	}
+}
+
+
+/**
+ * Play a sequence out on a fresh board. The hashes are only used to find likely duplicates, this is what checks them
+ */
+static void play_out(short* board, const struct sequence* sequence){
+	for(int i = 0; i < BOARD_CELLS; i++){
+		board[i] = i;
+	}
+	board[BOARD_MIDDLE] = 0;
+	board[0] = BOARD_MIDDLE;
+
+	int blank = BOARD_MIDDLE;
+	for(int i = sequence->length - 1; i >= 0; i--){
+		int move = (sequence->moves >> (2 * i)) & 3;
+		int cell = blank + row_step[move] * BOARD_WIDTH + column_step[move];
+
+		board[blank] = board[cell];
+		board[cell] = 0;
+		blank = cell;
+	}
+}
+
+
+/**
+ * Sort sequences by the board that they end on, shortest first
+ */
+static int compare_by_board(const void* a, const void* b){
+	const struct sequence* first = (const struct sequence*)a;
+	const struct sequence* second = (const struct sequence*)b;
+
+	if(first->hash != second->hash){
+		return first->hash < second->hash ? -1 : 1;
+	}
+
+	return first->length - second->length;
+}
+
+
+/**
+ * Sort sequences by their length and then their moves, so that they can be searched for
+ */
+static int compare_by_moves(const void* a, const void* b){
+	const struct sequence* first = (const struct sequence*)a;
+	const struct sequence* second = (const struct sequence*)b;
+
+	if(first->length != second->length){
+		return first->length - second->length;
+	}
+
+	return first->moves < second->moves ? -1 : first->moves > second->moves;
+}
+
+
+/**
+ * Returns 1 if shorter ends on the same board as sequence and never leaves the rows and columns that it covers
+ */
+static int shorter_duplicate(const struct sequence* sequence, const struct sequence* shorter, short* scratch, short* other){
+	if(shorter->length >= sequence->length || shorter->top < sequence->top || shorter->bottom > sequence->bottom
+	   || shorter->left < sequence->left || shorter->right > sequence->right){
+		return 0;
+	}
+
+	play_out(scratch, sequence);
+	play_out(other, shorter);
+
+	return memcmp(scratch, other, sizeof(short) * BOARD_CELLS) == 0;
+}
+
+
+/**
+ * Returns 1 if any part of sequence other than all of it is one of the sorted duplicates
+ */
+static int has_inner_duplicate(const struct sequence* sequence, const struct sequence* sorted, const int count){
+	for(int start = 0; start < sequence->length; start++){
+		for(int end = start + 1; end <= sequence->length; end++){
+			if(end - start == sequence->length){
+				continue;
+			}
+
+			//The moves from start up to end, counted from the first move
+			struct sequence part;
+			part.length = end - start;
+			part.moves = (sequence->moves >> (2 * (sequence->length - end))) & ((1u << (2 * part.length)) - 1);
+
+			if(bsearch(&part, sorted, count, sizeof(struct sequence), compare_by_moves) != NULL){
+				return 1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+
+/**
+ * Find every duplicate that has no shorter duplicate inside of it. Returns 0 on success and -1 on failure
+ */
+static int find_duplicates(){
+	struct duplicate_finder* finder = calloc(1, sizeof(struct duplicate_finder));
+	//1 sequence with no moves, then 4 times 3 to the length minus 1 with every length after that
+	int max_sequences = 1;
+	for(int length = 1, count = 4; length <= MOVE_PRUNING_DEPTH; length++, count *= 3){
+		max_sequences += count;
+	}
+	finder->sequences = malloc(sizeof(struct sequence) * max_sequences);
+	struct sequence* found = malloc(sizeof(struct sequence) * max_sequences);
+	short* scratch = malloc(sizeof(short) * BOARD_CELLS);
+	short* other = malloc(sizeof(short) * BOARD_CELLS);
+
+	if(finder->sequences == NULL || found == NULL || scratch == NULL || other == NULL){
+		free(finder->sequences);
+		free(finder);
+		free(found);
+		free(scratch);
+		free(other);
+		return -1;
+	}
+
+	//Every sequence starts from the blank in the middle, which is all that it has covered so far
+	struct sequence empty = {0, 0, 0, MOVE_PRUNING_DEPTH, MOVE_PRUNING_DEPTH, MOVE_PRUNING_DEPTH, MOVE_PRUNING_DEPTH};
+	play_out(finder->board, &empty);
+	play_sequences(finder, empty, BOARD_MIDDLE, -1);
+
+	//Every board that more than one sequence ends on is next to each other, with the shortest sequence first
+	qsort(finder->sequences, finder->num_sequences, sizeof(struct sequence), compare_by_board);
+
+	int num_found = 0;
+	for(int first = 0; first < finder->num_sequences; ){
+		int end = first;
+		while(end < finder->num_sequences && finder->sequences[end].hash == finder->sequences[first].hash){
+			end++;
+		}
+
+		for(int i = first; i < end; i++){
+			for(int j = first; j < end && finder->sequences[j].length < finder->sequences[i].length; j++){
+				if(shorter_duplicate(&(finder->sequences[i]), &(finder->sequences[j]), scratch, other) == 1){
+					found[num_found] = finder->sequences[i];
+					num_found++;
+					break;
+				}
+			}
+		}
+
+		first = end;
+	}
+
+	//Only the duplicates with nothing shorter inside of them are needed, the rest are pruned before they get that far
+	qsort(found, num_found, sizeof(struct sequence), compare_by_moves);
+	duplicates = malloc(sizeof(struct sequence) * (num_found > 0 ? num_found : 1));
+	num_duplicates = 0;
+	for(int i = 0; i < num_found; i++){
+		if(has_inner_duplicate(&(found[i]), found, num_found) == 0){
+			duplicates[num_duplicates] = found[i];
+			num_duplicates++;
+		}
+	}
+
+	free(finder->sequences);
+	free(finder);
+	free(found);
+	free(scratch);
+	free(other);
+
+	return 0;
+}
+
+
+/**
+ * Add a sequence to the trie that the machine is built from, and mark where it ends
+ */
+static void add_to_trie(int** children, char** ends, int* num_nodes, int* max_nodes, const u_int32_t moves, const int length){
+	int node = 0;
+
+	for(int i = length - 1; i >= 0; i--){
+		int move = (moves >> (2 * i)) & 3;
+
+		if((*children)[node * 4 + move] == -1){
+			if(*num_nodes == *max_nodes){
+				*max_nodes *= 2;
+				*children = realloc(*children, sizeof(int) * 4 * *max_nodes);
+				*ends = realloc(*ends, *max_nodes);
+			}
+
+			memset(&((*children)[*num_nodes * 4]), -1, sizeof(int) * 4);
+			(*ends)[*num_nodes] = 0;
+			(*children)[node * 4 + move] = *num_nodes;
+			(*num_nodes)++;
+		}
+
+		node = (*children)[node * 4 + move];
+	}
+
+	(*ends)[node] = 1;
+}
+
+
+/**
+ * Build the Aho-Corasick machine for every duplicate that fits on an NxN board, along with every move undoing the
+ * last one
+ */
+static struct move_pruning_machine* build_machine(const int N){
+	int max_nodes = 256;
+	int num_nodes = 1;
+	int* children = malloc(sizeof(int) * 4 * max_nodes);
+	char* ends = malloc(max_nodes);
+	memset(children, -1, sizeof(int) * 4);
+	ends[0] = 0;
+
+	for(int move = 0; move < 4; move++){
+		add_to_trie(&children, &ends, &num_nodes, &max_nodes, (move << 2) | (move ^ 1), 2);
+	}
+
+	for(int i = 0; i < num_duplicates; i++){
+		if(duplicates[i].bottom - duplicates[i].top < N && duplicates[i].right - duplicates[i].left < N){
+			add_to_trie(&children, &ends, &num_nodes, &max_nodes, duplicates[i].moves, duplicates[i].length);
+		}
+	}
+
+	//Breadth first over the trie, so that every node's failure link is done before its children need it
+	int* transitions = malloc(sizeof(int) * 4 * num_nodes);
+	int* failure = malloc(sizeof(int) * num_nodes);
+	int* queue = malloc(sizeof(int) * num_nodes);
+	int head = 0;
+	int tail = 0;
+
+	failure[0] = 0;
+	queue[tail++] = 0;
+	while(head < tail){
+		int node = queue[head++];
+
+		for(int move = 0; move < 4; move++){
+			int child = children[node * 4 + move];
+
+			//No duplicate goes this way from here, so fall back to the longest end of the path that one does
+			if(child == -1){
+				transitions[node * 4 + move] = node == 0 ? 0 : transitions[failure[node] * 4 + move];
+				continue;
+			}
+
+			failure[child] = node == 0 ? 0 : transitions[failure[node] * 4 + move];
+			transitions[node * 4 + move] = child;
+			queue[tail++] = child;
+		}
+	}
+
+	//No duplicate has another one inside of it, so a path only ever finishes one at the node where it ends. Those
+	//nodes become MOVE_PRUNED, and the rest are numbered in breadth first order, so the root is MOVE_PRUNING_START
+	int* numbers = malloc(sizeof(int) * num_nodes);
+	int num_states = 0;
+	for(int i = 0; i < num_nodes; i++){
+		numbers[queue[i]] = ends[queue[i]] == 1 ? MOVE_PRUNED : num_states++;
+	}
+
+	//A failure is a shorter end of the same path, so it's never the end of a duplicate either
+	u_int16_t* table = malloc(sizeof(u_int16_t) * 4 * num_states);
+	u_int16_t* failures = malloc(sizeof(u_int16_t) * num_states);
+	for(int i = 0; i < num_nodes; i++){
+		if(ends[i] == 1){
+			continue;
+		}
+
+		for(int move = 0; move < 4; move++){
+			table[numbers[i] * 4 + move] = numbers[transitions[i * 4 + move]];
+		}
+
+		failures[numbers[i]] = numbers[failure[i]];
+	}
+
+	struct move_pruning_machine* machine = malloc(sizeof(struct move_pruning_machine));
+	machine->N = N;
+	machine->num_states = num_states;
+	machine->transitions = table;
+	machine->failures = failures;
+
+	free(children);
+	free(ends);
+	free(transitions);
+	free(failure);
+	free(queue);
+	free(numbers);
+
+	return machine;
+}
+
+
+/**
+ * Build the move pruning machine for N, finding the duplicates first if this is the first one
+ */
+int initialize_move_pruning(const int N){
+	if(N < 2){
+		return -1;
+	}
+
+	int size = N < MOVE_PRUNING_MAX_N ? N : MOVE_PRUNING_MAX_N;
+
+	//We already have it
+	if(machines[size] != NULL){
+		return 0;
+	}
+
+	if(num_duplicates == -1 && find_duplicates() == -1){
+		return -1;
+	}
+
+	machines[size] = build_machine(size);
+
+	return 0;
+}
+
+
+/**
+ * Get the machine for N, or the inverse move machine if that's what was asked for or the machine isn't there
+ */
+const struct move_pruning_machine* move_pruning_machine(const int N, move_pruning_type type){
+	int size = N < MOVE_PRUNING_MAX_N ? N : MOVE_PRUNING_MAX_N;
+
+	if(type == MOVE_PRUNING_INVERSE || size < 2 || machines[size] == NULL){
+		return &inverse_machine;
+	}
+
+	return machines[size];
+}
@@ -0,0 +1,88 @@
+/**
+ * Author: Jack Robbins
+ * This header file defines move pruning, which lets a search skip a move before it makes a single successor for it.
+ * A finite state machine reads the moves along a path one at a time, and a move that would finish a known duplicate
+ * sequence has no transition at all. The functions are implemented in move_pruning.c
+ */
+
+#ifndef MOVE_PRUNING_H
+#define MOVE_PRUNING_H
+
+//The longest sequence of moves that is checked for a shorter duplicate when the machine is built
+#define MOVE_PRUNING_DEPTH 11
+//A sequence this long never covers more than this many rows or columns, so every N from here on shares one machine
+#define MOVE_PRUNING_MAX_N (MOVE_PRUNING_DEPTH + 1)
+//The machine state of a path that hasn't made any moves yet, in every machine
+#define MOVE_PRUNING_START 0
+//The transition for a move that must never be made
+#define MOVE_PRUNED 0xFFFF
+
+#include <sys/types.h>
+
+/**
+ * The ways that a search can prune its moves. Both are sound, neither ever costs a search its optimal solution
+ */
+typedef enum {
+	//Only ever skip the move that undoes the last one
+	MOVE_PRUNING_INVERSE,
+	//Also skip every move that finishes a sequence which is the same as a shorter one, like going most of the way
+	//around a 2x2 square and back. Falls back to MOVE_PRUNING_INVERSE if the machine wasn't built for N
+	MOVE_PRUNING_MACHINE
+} move_pruning_type;
+
+
+/**
+ * A finite state machine over the moves of the blank, 0 = left move, 1 = right move, 2 = down move, 3 = up move.
+ * Every state is the longest end of the path so far that could still grow into a duplicate sequence, and
+ * transitions has 4 entries for every state, one for every move, that are either the next state or MOVE_PRUNED.
+ * failures has the state for the next longest end of the path, the one that the machine falls back to
+ */
+struct move_pruning_machine {
+	int N;
+	int num_states;
+	const u_int16_t* transitions;
+	const u_int16_t* failures;
+};
+
+
+/**
+ * Build the move pruning machine for N out of every duplicate sequence that fits on an NxN board. The duplicates are
+ * only ever searched for once, and every N from MOVE_PRUNING_MAX_N on shares the same machine. This is not thread
+ * safe, so it should be called before anything is solved. Returns 0 on success and -1 on failure
+ */
+int initialize_move_pruning(const int N);
+
+/**
+ * Get the machine that prunes moves for N the given way. This is never NULL, since the inverse move machine is
+ * always there to fall back to
+ */
+const struct move_pruning_machine* move_pruning_machine(const int N, move_pruning_type type);
+
+
+/**
+ * The machine state after move is made from the given state, or MOVE_PRUNED if move should never be made
+ */
+static inline int next_move_state(const struct move_pruning_machine* machine, const int move_state, const int move){
+	return machine->transitions[move_state * 4 + move];
+}
+
+
+/**
+ * Returns 1 if the machine prunes no more below a state reached in covering than below one reached in move_state.
+ * A state that stands for a shorter end of the path knows less about what came before, so it never prunes anything
+ * that a longer one doesn't. That makes this true exactly when covering is move_state or one of its failures
+ */
+static inline int move_state_covers(const struct move_pruning_machine* machine, const int covering, int move_state){
+	while(move_state != covering){
+		//Nothing is shorter than a path with no moves
+		if(move_state == MOVE_PRUNING_START){
+			return 0;
+		}
+
+		move_state = machine->failures[move_state];
+	}
+
+	return 1;
+}
+
+#endif /* MOVE_PRUNING_H */
@@ -6,15 +6,86 @@
 
 //Link to puzzle.h
 #include "puzzle.h"
+//For the random walk that start configurations are made with
+#include "random_generator.h"
+//For the pattern database heuristic
+#include "../heuristic/pattern_database.h"
+//For the walking distance heuristic
+#include "../heuristic/walking_distance.h"
+
+//The vector kernels are only built for x86, and not at all with -DNO_SIMD_KERNELS
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(NO_SIMD_KERNELS)
+#include <immintrin.h>
+#define SIMD_KERNELS_AVAILABLE
+#endif
+
+//The smallest size that gets its own specialized kernels, every size from here up to PACKED_MAX_N does
+#define SPECIALIZED_MIN_N 3
+//The number of specialized sizes, and the most tiles that any of them has
+#define SPECIALIZED_SIZES (PACKED_MAX_N - SPECIALIZED_MIN_N + 1)
+#define SPECIALIZED_TILES (PACKED_MAX_N * PACKED_MAX_N)
+
+/**
+ * Call a kernel with N as a compile time constant for every specialized size, and with N as it is for everything
+ * else. The kernels are always inlined, so the compiler builds a copy of each one for every size where the packed
+ * word width and every division and modulo by N are constants, and the loops over a row or column can be unrolled.
+ * N is the same for the whole solve, so the switch always goes the same way
+ */
+#define SPECIALIZE_N(N, kernel, ...) \
+	switch(N){ \
+		case 3: kernel(__VA_ARGS__, 3); break; \
+		case 4: kernel(__VA_ARGS__, 4); break; \
+		case 5: kernel(__VA_ARGS__, 5); break; \
+		default: kernel(__VA_ARGS__, N); break; \
+	}
+
+/**
+ * The lookup tables for the specialized sizes are all filled in by the preprocessor. TABLE_25 expands a macro for
+ * every position or tile 0 through 24, whether or not the board is that big, since the extra ones are never read
+ */
+#define TABLE_5(M, N, t, p) M(N, t, p), M(N, t, (p) + 1), M(N, t, (p) + 2), M(N, t, (p) + 3), M(N, t, (p) + 4)
+#define TABLE_25(M, N, t) TABLE_5(M, N, t, 0), TABLE_5(M, N, t, 5), TABLE_5(M, N, t, 10), TABLE_5(M, N, t, 15), TABLE_5(M, N, t, 20)
+//The absolute difference, written so that it's a constant expression
+#define TABLE_DIFFERENCE(a, b) ((a) > (b) ? (a) - (b) : (b) - (a))
+//How far tile t sitting at position p is from where it belongs. The blank is never counted
+#define TABLE_DISTANCE(N, t, p) ((t) == 0 ? 0 : TABLE_DIFFERENCE((p) / (N), ((t) - 1) / (N)) + TABLE_DIFFERENCE((p) % (N), ((t) - 1) % (N)))
+//The goal row and column of tile t. The blank's are -1, so it's never in its goal row or column
+#define TABLE_GOAL_ROW(N, unused, t) ((t) == 0 ? -1 : ((t) - 1) / (N))
+#define TABLE_GOAL_COLUMN(N, unused, t) ((t) == 0 ? -1 : ((t) - 1) % (N))
+//Every row of the distance table for one size
+#define TABLE_DISTANCE_ROWS_5(N, t) {TABLE_25(TABLE_DISTANCE, N, t)}, {TABLE_25(TABLE_DISTANCE, N, (t) + 1)}, \
+	{TABLE_25(TABLE_DISTANCE, N, (t) + 2)}, {TABLE_25(TABLE_DISTANCE, N, (t) + 3)}, {TABLE_25(TABLE_DISTANCE, N, (t) + 4)}
+#define TABLE_DISTANCE_ROWS(N) {TABLE_DISTANCE_ROWS_5(N, 0), TABLE_DISTANCE_ROWS_5(N, 5), TABLE_DISTANCE_ROWS_5(N, 10), \
+	TABLE_DISTANCE_ROWS_5(N, 15), TABLE_DISTANCE_ROWS_5(N, 20)}
+
+//The manhattan distance of every tile from every position, for every specialized size
+static const unsigned char distance_table[SPECIALIZED_SIZES][SPECIALIZED_TILES][SPECIALIZED_TILES] = {
+	TABLE_DISTANCE_ROWS(3), TABLE_DISTANCE_ROWS(4), TABLE_DISTANCE_ROWS(5)
+};
+
+//The goal row and column of every tile, for every specialized size
+static const signed char goal_row_table[SPECIALIZED_SIZES][SPECIALIZED_TILES] = {
+	{TABLE_25(TABLE_GOAL_ROW, 3, 0)}, {TABLE_25(TABLE_GOAL_ROW, 4, 0)}, {TABLE_25(TABLE_GOAL_ROW, 5, 0)}
+};
+static const signed char goal_column_table[SPECIALIZED_SIZES][SPECIALIZED_TILES] = {
+	{TABLE_25(TABLE_GOAL_COLUMN, 3, 0)}, {TABLE_25(TABLE_GOAL_COLUMN, 4, 0)}, {TABLE_25(TABLE_GOAL_COLUMN, 5, 0)}
+};
 
 
 /**
  * The initialize_state function takes in a pointer to a state and reserves the appropriate space for the dynamic array
- * that holds the tiles 
+ * that holds the tiles. Small puzzles are packed into the state itself, so they need no tile array at all
  */
 void initialize_state(struct state* statePtr, const int N){
-	//Declare all of the pointers needed for each row
-	statePtr->tiles = (short*)malloc(sizeof(short) * N * N);
+	//Small puzzles use the packed word, which starts out as all blanks
+	if(N <= PACKED_MAX_N){
+		statePtr->packed = 0;
+		statePtr->packed_high = 0;
+	} else {
+		//Declare all of the pointers needed for each row
+		statePtr->tiles = (short*)malloc(sizeof(short) * N * N);
+	}
+
 	statePtr->predecessor = NULL;
 	statePtr->next = NULL;
 }
@@ -23,9 +94,197 @@ void initialize_state(struct state* statePtr, const int N){
 /**
  * The destroy_state function does the exact reverse of the initialize_state function to properly free memory
  */
-void destroy_state(struct state* statePtr){
-	//We only need to free the tile pointer in this case
-	free(statePtr->tiles);
+void destroy_state(struct state* statePtr, const int N){
+	//We only need to free the tile pointer in this case, packed states don't have one
+	if(N > PACKED_MAX_N){
+		free(statePtr->tiles);
+	}
+}
+
+
+/**
+ * How many bytes a state of a puzzle of size N takes up, counting its tile array. The states of puzzles up to
+ * PACKED_SMALL_MAX_N leave off the high half of the packed word, which is why it's the last thing in the struct
+ */
+size_t state_size(const int N){
+	if(N <= PACKED_SMALL_MAX_N){
+		return offsetof(struct state, packed_high);
+	}
+
+	if(N <= PACKED_MAX_N){
+		return sizeof(struct state);
+	}
+
+	return sizeof(struct state) + sizeof(short) * N * N;
+}
+
+
+/**
+ * The number of bits that every tile takes up in a packed word for a puzzle of size N
+ */
+static inline int packed_width(const int N){
+	return N <= 4 ? 4 : 5;
+}
+
+
+/**
+ * The whole packed word of a state. For N <= PACKED_SMALL_MAX_N there is no high half to read
+ */
+static inline __attribute__((always_inline)) packed_tiles packed_word(struct state* statePtr, const int N){
+	if(N <= PACKED_SMALL_MAX_N){
+		return statePtr->packed;
+	}
+
+	return (packed_tiles)statePtr->packed_high << 64 | statePtr->packed;
+}
+
+
+/**
+ * Put a whole packed word into a state, the reverse of packed_word
+ */
+static inline __attribute__((always_inline)) void store_packed_word(struct state* statePtr, packed_tiles packed, const int N){
+	statePtr->packed = (u_int64_t)packed;
+
+	if(N > PACKED_SMALL_MAX_N){
+		statePtr->packed_high = (u_int64_t)(packed >> 64);
+	}
+}
+
+
+/**
+ * Get the tile at the given index out of a packed word
+ */
+static inline short packed_get(packed_tiles packed, const int index, const int N){
+	int width = packed_width(N);
+	return (short)((packed >> (index * width)) & ((1 << width) - 1));
+}
+
+
+/**
+ * Get the tile at the given row major index in a state, whether it is packed or not
+ */
+short get_tile(struct state* statePtr, const int index, const int N){
+	if(N <= PACKED_MAX_N){
+		return packed_get(packed_word(statePtr, N), index, N);
+	}
+
+	return *(statePtr->tiles + index);
+}
+
+
+/**
+ * The kernel version of get_tile. Packed states are exactly the ones up to PACKED_MAX_N, so when N is a constant this
+ * needs no check at all
+ */
+static inline __attribute__((always_inline)) short tile_at(struct state* statePtr, const int index, const int N){
+	if(N <= PACKED_MAX_N){
+		return packed_get(packed_word(statePtr, N), index, N);
+	}
+
+	return *(statePtr->tiles + index);
+}
+
+
+/**
+ * The goal row of a tile, from the table for the specialized sizes
+ */
+static inline __attribute__((always_inline)) int goal_row_of(const short tile, const int N){
+	if(N >= SPECIALIZED_MIN_N && N <= PACKED_MAX_N){
+		return goal_row_table[N - SPECIALIZED_MIN_N][tile];
+	}
+
+	return (tile - 1) / N;
+}
+
+
+/**
+ * The goal column of a tile, from the table for the specialized sizes
+ */
+static inline __attribute__((always_inline)) int goal_column_of(const short tile, const int N){
+	if(N >= SPECIALIZED_MIN_N && N <= PACKED_MAX_N){
+		return goal_column_table[N - SPECIALIZED_MIN_N][tile];
+	}
+
+	return (tile - 1) % N;
+}
+
+
+/**
+ * How far a tile sitting at the given position is from where it belongs, from the table for the specialized sizes
+ */
+static inline __attribute__((always_inline)) int tile_distance(const short tile, const int position, const int N){
+	if(N >= SPECIALIZED_MIN_N && N <= PACKED_MAX_N){
+		return distance_table[N - SPECIALIZED_MIN_N][tile][position];
+	}
+
+	return abs(position / N - (tile - 1) / N) + abs(position % N - (tile - 1) % N);
+}
+
+
+/**
+ * Put a tile at the given row major index in a state, whether it is packed or not. This does not update
+ * the hash, so callers that build a state tile by tile must call hash_state when they are done
+ */
+void set_tile(struct state* statePtr, const int index, const short tile, const int N){
+	if(N <= PACKED_MAX_N){
+		int width = packed_width(N);
+		packed_tiles packed = packed_word(statePtr, N);
+		//Clear out whatever was there and put the new tile in
+		packed &= ~((packed_tiles)((1 << width) - 1) << (index * width));
+		packed |= (packed_tiles)tile << (index * width);
+		store_packed_word(statePtr, packed, N);
+		return;
+	}
+
+	*(statePtr->tiles + index) = tile;
+}
+
+
+/**
+ * Copy the tiles of a state out into a plain row major array, whether the state is packed or not
+ */
+void unpack_tiles(struct state* statePtr, short* tiles, const int N){
+	//Nothing to unpack for a tile array
+	if(N > PACKED_MAX_N){
+		memcpy(tiles, statePtr->tiles, sizeof(short) * N * N);
+		return;
+	}
+
+	int width = packed_width(N);
+	int mask = (1 << width) - 1;
+	packed_tiles packed = packed_word(statePtr, N);
+
+	//Peel the tiles off of the bottom of the word one by one
+	for(int i = 0; i < N * N; i++){
+		tiles[i] = (short)(packed & mask);
+		packed >>= width;
+	}
+}
+
+
+/**
+ * The packed equivalent of the move functions. Slide the tile at tile_index into the blank at blank_index and
+ * give back the new word. Since the blank is all zero bits, this is just moving the tile's bits over
+ */
+packed_tiles packed_move(packed_tiles packed, const int blank_index, const int tile_index, const int N){
+	int width = packed_width(N);
+	packed_tiles tile = (packed >> (tile_index * width)) & ((1 << width) - 1);
+
+	//Clear the tile out of its old position, and put it where the blank was
+	packed &= ~(tile << (tile_index * width));
+	return packed | (tile << (blank_index * width));
+}
+
+
+/**
+ * The packed equivalent of hash_state. Mix both halves of the word through a multiply and xorshift so that
+ * the low bits of the hash depend on every tile
+ */
+u_int64_t packed_hash(packed_tiles packed){
+	u_int64_t hash = (u_int64_t)packed * 0x9e3779b97f4a7c15UL ^ (u_int64_t)(packed >> 64) * 0xc2b2ae3d27d4eb4fUL;
+	hash ^= hash >> 32;
+	hash *= 0xff51afd7ed558ccdUL;
+	return hash ^ (hash >> 29);
 }
 
 
@@ -40,10 +299,10 @@ void print_state(struct state* statePtr, const int N, int option){
 			//Support printing of states with 2 or 3 digit max integers
 			if(N < 11){	
 				//With numbers less than 11, N^2 is at most 99, so only 2 digits needed
-				printf("%2d ", *(statePtr->tiles + i * N + j));
+				printf("%2d ", get_tile(statePtr, i * N + j, N));
 			} else {
 				//Ensures printing of large states will not be botched
-				printf("%3d ", *(statePtr->tiles + i * N + j));
+				printf("%3d ", get_tile(statePtr, i * N + j, N));
 			}
 		}
 		//Support printing in a single line
@@ -56,16 +315,54 @@ void print_state(struct state* statePtr, const int N, int option){
 }
 
 
+/**
+ * Generate the Zobrist key for a given tile sitting in a given position. Instead of keeping a table of random
+ * numbers for every supported N, the key is generated by running the (position, tile) pair through the splitmix64
+ * finalizer, which gives us the same well distributed keys for any size puzzle
+ */
+static u_int64_t zobrist_key(const int position, const short tile){
+	u_int64_t key = ((u_int64_t)position << 16 | (u_int64_t)tile) + 0x9e3779b97f4a7c15UL;
+	key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9UL;
+	key = (key ^ (key >> 27)) * 0x94d049bb133111ebUL;
+	return key ^ (key >> 31);
+}
+
+
+/**
+ * Compute the hash of a state from scratch. For a tile array, this is the Zobrist hash: the xor of the keys of every
+ * (position, tile) pair, so the move functions are able to keep it up to date in O(1) instead of calling this again
+ */
+u_int64_t hash_state(struct state* statePtr, const int N){
+	//Packed states hash the whole word at once
+	if(N <= PACKED_MAX_N){
+		return packed_hash(packed_word(statePtr, N));
+	}
+
+	u_int64_t hash = 0;
+
+	//Fold in every tile
+	for(int i = 0; i < N * N; i++){
+		hash ^= zobrist_key(i, *(statePtr->tiles + i));
+	}
+
+	return hash;
+}
+
+
 /**
  * Performs a "deep copy" from the predecessor to the successor
  */
 void copy_state(struct state* predecessor, struct state* successor, const int N){
-	//Copy over the tiles array
-	for(int i = 0; i < N; i++){
-		for(int j = 0; j < N; j++){
-			//Copy tile by tile
-			*(successor->tiles + i * N + j) = *(predecessor->tiles + i * N + j);
+	//A packed state is copied in one go, the 5x5 has a second word to copy as well
+	if(N <= PACKED_MAX_N){
+		successor->packed = predecessor->packed;
+
+		if(N > PACKED_SMALL_MAX_N){
+			successor->packed_high = predecessor->packed_high;
 		}
+	} else {
+		//Copy over the tiles array in one go
+		memcpy(successor->tiles, predecessor->tiles, sizeof(short) * N * N);
 	}
 
 	//Initialize the current travel to the predecessor travel + 1
@@ -73,6 +370,8 @@ void copy_state(struct state* predecessor, struct state* successor, const int N)
 	//Copy the zero row and column position
 	successor->zero_row = predecessor->zero_row;
 	successor->zero_column = predecessor->zero_column;
+	//The tiles are the same, so the hash is too
+	successor->hash = predecessor->hash;
 	//Initialize the successor's next to be null
 	successor->next = NULL;
 	//Set the successors predecessor
@@ -84,13 +383,35 @@ void copy_state(struct state* predecessor, struct state* successor, const int N)
  * A simple function that swaps two tiles in the provided state
  * Note: The swap function assumes all row positions are valid, this must be checked by the caller
  */
-static void swap_tiles(int row1, int column1, int row2, int column2, struct state* statePtr, const int N){
+static inline __attribute__((always_inline)) void swap_tiles_kernel(int row1, int column1, int row2, int column2,
+																	struct state* statePtr, const int N){
+	//For a packed state, one of the two tiles is always the blank, so slide the other one over and rehash the word
+	if(N <= PACKED_MAX_N){
+		packed_tiles packed = packed_move(packed_word(statePtr, N), row1 * N + column1, row2 * N + column2, N);
+		store_packed_word(statePtr, packed, N);
+		statePtr->hash = packed_hash(packed);
+		return;
+	}
+
 	//Store the first tile in a temp variable
 	short tile = *(statePtr->tiles + row1 * N + column1);
+	short other = *(statePtr->tiles + row2 * N + column2);
 	//Put the tile from row2, column2 into row1, column1
-	*(statePtr->tiles + row1 * N + column1) = *(statePtr->tiles + row2 * N + column2);
+	*(statePtr->tiles + row1 * N + column1) = other;
 	//Put the temp in row2, column2
 	*(statePtr->tiles + row2 * N + column2) = tile;
+
+	//Update the Zobrist hash by taking both tiles out of their old positions and into their new ones
+	statePtr->hash ^= zobrist_key(row1 * N + column1, tile) ^ zobrist_key(row1 * N + column1, other)
+					^ zobrist_key(row2 * N + column2, other) ^ zobrist_key(row2 * N + column2, tile);
+}
+
+
+/**
+ * Swap two tiles, with the kernel specialized for N
+ */
+static void swap_tiles(int row1, int column1, int row2, int column2, struct state* statePtr, const int N){
+	SPECIALIZE_N(N, swap_tiles_kernel, row1, column1, row2, column2, statePtr)
 }
 
 
@@ -138,24 +459,171 @@ void move_left(struct state* statePtr, const int N){
 }
 
 
+/**
+ * Compare two tile arrays one tile at a time. Returns 1 if they're the same, 0 if not
+ */
+static int tiles_equal_scalar(const short* a, const short* b, const int count){
+	for(int i = 0; i < count; i++){
+		if(a[i] != b[i]){
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+
+/**
+ * Add up the manhattan distance of every tile from where it should be, one tile at a time. Conveniently, each tile
+ * t should be in position t - 1, so its goal row and column are just that divided and modulated by N. This is only
+ * for a state with no predecessor to work from, every other one is updated incrementally
+ */
+static int manhattan_distance(const short* tiles, const int N){
+	int distance = 0;
+
+	for(int i = 0; i < N * N; i++){
+		//We do not care about 0 as it can move, so skip it
+		if(tiles[i] == 0){
+			continue;
+		}
+
+		distance += abs(i / N - (tiles[i] - 1) / N) + abs(i % N - (tiles[i] - 1) % N);
+	}
+
+	return distance;
+}
+
+
+#ifdef SIMD_KERNELS_AVAILABLE
+/**
+ * Compare two tile arrays 8 tiles at a time with SSE
+ */
+__attribute__((target("sse4.1")))
+static int tiles_equal_sse(const short* a, const short* b, const int count){
+	int i = 0;
+
+	for(; i + 8 <= count; i += 8){
+		__m128i equal = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)(a + i)), _mm_loadu_si128((const __m128i*)(b + i)));
+		//Every byte of every equal tile is all ones
+		if(_mm_movemask_epi8(equal) != 0xFFFF){
+			return 0;
+		}
+	}
+
+	//Whatever doesn't fill a whole vector
+	return tiles_equal_scalar(a + i, b + i, count - i);
+}
+
+
+/**
+ * Compare two tile arrays 16 tiles at a time with AVX2
+ */
+__attribute__((target("avx2")))
+static int tiles_equal_avx2(const short* a, const short* b, const int count){
+	int i = 0;
+
+	for(; i + 16 <= count; i += 16){
+		__m256i equal = _mm256_cmpeq_epi16(_mm256_loadu_si256((const __m256i*)(a + i)), _mm256_loadu_si256((const __m256i*)(b + i)));
+		if(_mm256_movemask_epi8(equal) != -1){
+			return 0;
+		}
+	}
+
+	return tiles_equal_scalar(a + i, b + i, count - i);
+}
+#endif
+
+
+//The kernel in use. This is the scalar one until initialize_simd_kernels finds something better
+static int (*tiles_equal)(const short* a, const short* b, const int count) = tiles_equal_scalar;
+static const char* simd_kernels = "scalar";
+
+
+/**
+ * Pick the fastest tile comparison that this processor supports. This should be called once when the program starts,
+ * before any solver thread is running. Only puzzles bigger than PACKED_MAX_N have tile arrays to compare, everything
+ * smaller compares its packed words instead
+ */
+void initialize_simd_kernels(void){
+#ifdef SIMD_KERNELS_AVAILABLE
+	__builtin_cpu_init();
+
+	if(__builtin_cpu_supports("avx2")){
+		tiles_equal = tiles_equal_avx2;
+		simd_kernels = "AVX2";
+	} else if(__builtin_cpu_supports("sse4.1")){
+		tiles_equal = tiles_equal_sse;
+		simd_kernels = "SSE4.1";
+	}
+#endif
+}
+
+
+/**
+ * The name of the kernel that initialize_simd_kernels picked
+ */
+const char* simd_kernel_name(void){
+	return simd_kernels;
+}
+
+
 /**
  * A simple helper function that will tell if two states are the same. To be used for filtering
  */
 int states_same(struct state* a, struct state* b, const int N){
-	//Efficiency speedup -- if zero row and column aren't equal, return false
-	if(a->zero_row != b->zero_row || a->zero_column != b->zero_column){
+	//Efficiency speedup -- if the hashes or the zero row and column aren't equal, return false
+	if(a->hash != b->hash || a->zero_row != b->zero_row || a->zero_column != b->zero_column){
 		return 0;
 	}
 
-	//Go through each row in the dynamic tile matrix in both states
-	for(int i = 0; i < N * N; i++){
-		if(*(a->tiles + i) != *(b->tiles + i)){ 
-			return 0;
+	//Packed states are the same if their words are the same
+	if(N <= PACKED_MAX_N){
+		return a->packed == b->packed && (N <= PACKED_SMALL_MAX_N || a->packed_high == b->packed_high);
+	}
+
+	//Go through the dynamic tile matrix in both states, as many tiles at a time as the processor can
+	return tiles_equal(a->tiles, b->tiles, N * N);
+}
+
+
+/**
+ * Count how many tiles have to leave a line, a row if is_row is 1 or a column otherwise, so that the rest of the
+ * tiles that belong in it can reach their goal spots. The longest run of them that is already in order can stay, and
+ * every other one has to get out of the way. Counting every out of order pair instead would count a tile that is out
+ * of order with two others twice, which overestimates a line with three or more of them in conflict
+ */
+static inline __attribute__((always_inline)) int line_conflicts(struct state* statePtr, const int line, const int is_row,
+																 const int N){
+	//The goal spots of the tiles that belong in this line, in the order that they sit in it
+	int goals[N];
+	//The longest run in order that ends at each of them
+	int longest[N];
+	int num_goals = 0;
+	int longest_overall = 0;
+
+	for(int k = 0; k < N; k++){
+		short tile = tile_at(statePtr, is_row == 1 ? line * N + k : k * N + line, N);
+
+		//The blank, and any tile that doesn't belong in this line, is never in the way
+		if(tile == 0 || (is_row == 1 ? goal_row_of(tile, N) : goal_column_of(tile, N)) != line){
+			continue;
 		}
+
+		goals[num_goals] = is_row == 1 ? goal_column_of(tile, N) : goal_row_of(tile, N);
+		longest[num_goals] = 1;
+		for(int j = 0; j < num_goals; j++){
+			if(goals[j] < goals[num_goals] && longest[j] + 1 > longest[num_goals]){
+				longest[num_goals] = longest[j] + 1;
+			}
+		}
+
+		if(longest[num_goals] > longest_overall){
+			longest_overall = longest[num_goals];
+		}
+		num_goals++;
 	}
 
-	//Return 1 if same	
-	return 1;
+	return num_goals - longest_overall;
 }
 
 
@@ -170,7 +638,15 @@ void update_prediction_function(struct state* statePtr, const int N){
 	}
 
 	//The current_travel of the state has already been updated by stateCopy, so we only need to find the heuristic_cost
-	statePtr->heuristic_cost = 0;
+
+	//Packed states are unpacked once up front, so that the loops below can index the tiles directly
+	short unpacked[PACKED_MAX_N * PACKED_MAX_N];
+	short* tiles = unpacked;
+	if(N > PACKED_MAX_N){
+		tiles = statePtr->tiles;
+	} else {
+		unpack_tiles(statePtr, unpacked, N);
+	}
 
 	/**
 	* For heuristic_cost, we will use the manhattan distance from each tile to where it should be.
@@ -178,141 +654,144 @@ void update_prediction_function(struct state* statePtr, const int N){
 	* doing the sum of the absolute difference in coordinates from a number's current state position
 	* to its goal state position
 	*/
-
-	//Declare all needed variables
-	short selected_num, goal_rowCor, goal_colCor;
-	//Keep track of the manhattan distance
-	int manhattan_distance;
-	
-	//Go through each tile in the state and calculate the heuristic_cost
-	for(int i = 0; i < N; i++){
-		for(int j = 0; j < N; j++){
-			//grab the number to be examined
-			selected_num = *(statePtr->tiles + i * N + j);
-
-			//We do not care about 0 as it can move, so skip it
-			if(selected_num == 0){
-				continue;
-			}
-
-			//Otherwise mathematically find the needed position
-			//Goal row coordinate is the index of the number divided by number of rows
-			goal_rowCor = (selected_num - 1) / N;
-			//Goal column coordinate is the index modulated by column length 
-			goal_colCor = (selected_num - 1) % N;
-				
-
-			//Manhattan distance is the absolute value of the x distance and the y distance
-			manhattan_distance = abs(i - goal_rowCor) + abs(j - goal_colCor);	
-		
-			//Add manhattan distance for each tile
-			statePtr->heuristic_cost += manhattan_distance;
+	if(N >= SPECIALIZED_MIN_N && N <= PACKED_MAX_N){
+		//The specialized sizes have every tile's distance from every position in a table
+		statePtr->heuristic_cost = 0;
+		for(int i = 0; i < N * N; i++){
+			statePtr->heuristic_cost += distance_table[N - SPECIALIZED_MIN_N][tiles[i]][i];
 		}
+	} else {
+		statePtr->heuristic_cost = manhattan_distance(tiles, N);
 	}
 		
 	/**
-	 * Now we must calculate the linear conflict heuristic. This heuristic takes two tiles in their goal row
-	 * or goal column and accounts for the fact that for each tile to be moved around, it actually takes
-	 * at least 2 additional moves. Given two tiles in their goal row, 2 additional vertical moves are added
-	 * to manhattan distance for each row/column amount that they have to move
-	 * 
+	 * Now we must calculate the linear conflict heuristic. Every tile that sits in its goal row or goal column, but
+	 * has to get past another tile in that line to reach its goal spot, has to step out of the line and back in,
+	 * which takes at least 2 moves that manhattan distance doesn't count
 	 */
-
-	//We initially have no linear conflicts
 	int linear_conflicts = 0;
-	//Declare for convenience
-	short left, right, above, below;
-	//Also declare goal row coordinates for convenience
-	short goal_rowCor_left, goal_rowCor_right, goal_colCor_above, goal_colCor_below;
-
-	//Check each row for linear conflicts
-	for(int i = 0; i < N; i++){
-		for(int j = 0; j < N-1; j++){
-			//Grab the leftmost tile that we'll be comparing to
-			left = *(statePtr->tiles + i * N + j);  
-
-			//If this tile is 0, it's irrelevant so do not explore further
-			if(left == 0){
-				continue;
-			}
-			
-			//Now go through every tile in the row after left, this is what makes this generalized linear conflict
-			for(int k = j+1; k < N; k++){
-				//Grab right tile for convenience
-				right = *(statePtr->tiles + i * N + k);
-
-				//Again, if the tile is 0, no use in wasting cycles with it
-				if(right == 0){
-					continue;
-				}
-				//Check if both tiles are in their goal row 
-				goal_rowCor_left = (left - 1) / N;
-				goal_rowCor_right = (right - 1) / N;
-
-				//If these tiles are not BOTH their goal row, linear conflict does not apply
-				//This is conterintuitive, but as it turns out makes an enormous difference
-				if(goal_rowCor_left != goal_rowCor_right || goal_rowCor_right != i){
-					continue;
-				}
-			
-				//If the tiles are swapped, we have a linear conflict
-				if(left > right){
-					//To be more informed, we should add 2 moves for EACH time we have to swap
-					linear_conflicts++;
-				}
-			}	
-		}
+
+	for(int line = 0; line < N; line++){
+		linear_conflicts += line_conflicts(statePtr, line, 1, N) + line_conflicts(statePtr, line, 0, N);
 	}
 
-	//Now check each column for linear conflicts 
-	for(int i = 0; i < N-1; i++){
-		for(int j = 0; j < N; j++){
-			//Grab the abovemost tile that we'll be comparing to
-			above = *(statePtr->tiles + i * N + j);
+	//For each tile that has to get out of the way, a minimum of 2 additional moves are required, so add 2 to the heuristic_cost
+	statePtr->heuristic_cost += linear_conflicts * 2;
+	//Save it on its own too, for the incremental update of the successors
+	statePtr->base_heuristic_cost = statePtr->heuristic_cost;
 
-			//If this tile is 0, it's irrelevant so do not explore further
-			if(above == 0){
-				continue;
-			}
+	//Once we have the heuristic_cost, update the total_cost
+	statePtr->total_cost = statePtr->heuristic_cost + statePtr->current_travel;
+}
 
-			//Now go through every tile in the column below "above", this is what makes it generalized linear conflict
-			for(int k = i+1; k < N; k++){
-				//Grab the below tile for convenience
-				below = *(statePtr->tiles + k * N + j);
-
-				//We don't care about the 0 tile, skip if we find it
-				if(below == 0){
-					continue;
-				}
-
-				//Check if both tiles are in their goal column
-				goal_colCor_above = (above - 1) % N;
-				goal_colCor_below = (below - 1) % N;
-
-				//If these tiles are not BOTH in their goal column, linear conflict does not apply
-				//This is counterintutive, but as it turns out makes an enormous difference
-				if(goal_colCor_below != goal_colCor_above || goal_colCor_above != j){
-					continue;
-				}
-
-				//If above is more than below, we have a linear conflict
-				if(above > below){
-					//To be more informed, we should add 2 moves for EACH time we have to swap
-					linear_conflicts++;				
-				}
-			}
+
+/**
+ * Update the prediction function for a successor by working from its predecessor's base_heuristic_cost instead of
+ * starting from scratch. A successor only differs from its predecessor by the one tile that slid into the
+ * predecessor's blank, so only that tile's manhattan distance changes. A horizontal move never changes the order
+ * of the tiles in a row, so only the moved tile's goal column can change, and the same goes for its goal row on a
+ * vertical move. This makes the update O(N^2) instead of the O(N^3) of update_prediction_function, and it gives back
+ * exactly the same value. Compile with -DHEURISTIC_CROSS_CHECK to verify that on every call
+ */
+static inline __attribute__((always_inline)) void incremental_kernel(struct state* statePtr, struct state* predecessor, const int N){
+	//The moved tile now sits where the predecessor's blank was, and it used to be where the blank now is
+	int new_row = predecessor->zero_row;
+	int new_column = predecessor->zero_column;
+	int old_row = statePtr->zero_row;
+	int old_column = statePtr->zero_column;
+	short tile = tile_at(statePtr, new_row * N + new_column, N);
+
+	//The change in the tile's manhattan distance
+	int change = tile_distance(tile, new_row * N + new_column, N) - tile_distance(tile, old_row * N + old_column, N);
+
+	//For each tile that has to get out of the way, 2 moves are gained or lost. The tile has left one column and
+	//joined another on a horizontal move, but it only ever counts in its goal column, so that's the only one that
+	//can change. The same goes for its goal row on a vertical move
+	if(old_row == new_row){
+		int line = goal_column_of(tile, N);
+		if(line == old_column || line == new_column){
+			change += 2 * (line_conflicts(statePtr, line, 0, N) - line_conflicts(predecessor, line, 0, N));
+		}
+	} else {
+		int line = goal_row_of(tile, N);
+		if(line == old_row || line == new_row){
+			change += 2 * (line_conflicts(statePtr, line, 1, N) - line_conflicts(predecessor, line, 1, N));
 		}
 	}
 
-	//Once we have calculated the number of linear conflicts, we add it into the heuristic cost
-	//For each linear conflict, a minimum of 2 additional moves are required to swap tiles, so add 2 to the heuristic_cost
-	statePtr->heuristic_cost += linear_conflicts * 2;
-
 	//Once we have the heuristic_cost, update the total_cost
+	statePtr->heuristic_cost = predecessor->base_heuristic_cost + change;
+	statePtr->base_heuristic_cost = statePtr->heuristic_cost;
 	statePtr->total_cost = statePtr->heuristic_cost + statePtr->current_travel;
 }
 
 
+/**
+ * Work out the heuristic cost of a state from its predecessor's, with the kernel specialized for N
+ */
+void update_prediction_function_incremental(struct state* statePtr, const int N){
+	//If statePtr is null, this state was a repeat, so don't calculate anything
+	if(statePtr == NULL){
+		return;
+	}
+
+	struct state* predecessor = statePtr->predecessor;
+
+	//Without a predecessor there's nothing to work from
+	if(predecessor == NULL){
+		update_prediction_function(statePtr, N);
+		return;
+	}
+
+	SPECIALIZE_N(N, incremental_kernel, statePtr, predecessor)
+
+#ifdef HEURISTIC_CROSS_CHECK
+	//Recompute from scratch and make sure that we agree
+	int incremental_cost = statePtr->heuristic_cost;
+	update_prediction_function(statePtr, N);
+
+	if(incremental_cost != statePtr->heuristic_cost){
+		printf("ERROR: Incremental heuristic cost %d does not match the full heuristic cost %d\n", incremental_cost, statePtr->heuristic_cost);
+		print_state(statePtr, N, 0);
+		abort();
+	}
+#endif
+}
+
+
+/**
+ * Estimate the remaining cost of a state with whichever heuristic the solver was asked to use, and update
+ * its total cost to match. Falls back to linear conflicts if the pattern database or walking distance can't be used
+ */
+void update_heuristic(struct state* statePtr, const int N, heuristic_type heuristic){
+	//If statePtr is null, this state was a repeat, so don't calculate anything
+	if(statePtr == NULL){
+		return;
+	}
+
+	//The pattern database is only for the 4x4 puzzle, and only if it's been loaded
+	if(heuristic == HEURISTIC_PATTERN_DATABASE && N == PATTERN_DATABASE_N && pattern_database_loaded()){
+		statePtr->heuristic_cost = pattern_database_cost(statePtr);
+		statePtr->total_cost = statePtr->current_travel + statePtr->heuristic_cost;
+		return;
+	}
+
+	update_prediction_function_incremental(statePtr, N);
+
+	//Walking distance and linear conflicts both only count moves that have to be made, so the larger of the two
+	//never overestimates either
+	if(heuristic == HEURISTIC_WALKING_DISTANCE && walking_distance_loaded(N)){
+		update_walking_distance(statePtr, N);
+
+		int walking_distance = walking_distance_cost(statePtr);
+		if(walking_distance > statePtr->heuristic_cost){
+			statePtr->heuristic_cost = walking_distance;
+			statePtr->total_cost = statePtr->current_travel + statePtr->heuristic_cost;
+		}
+	}
+}
+
+
 
 /**
  * This initialization function mathematically creates a goal state for a given 
@@ -330,11 +809,11 @@ struct state* initialize_goal(const int N){
 		//We can mathematically find row and column positions for inorder numbers
 		row = (num - 1) / N;
 		col = (num - 1) % N;
-		*(goal_state->tiles + row * N + col) = num;
+		set_tile(goal_state, row * N + col, num, N);
 	}
 
 	//0 is always at the last spot in the goal state
-	*(goal_state->tiles + N * N - 1) = 0;
+	set_tile(goal_state, N * N - 1, 0, N);
 
 	//Initialize everything else in the goal state
 	goal_state->zero_row = (goal_state)->zero_column = N-1;
@@ -342,24 +821,40 @@ struct state* initialize_goal(const int N){
 	goal_state->current_travel = 0;
 	goal_state->heuristic_cost = 0;
 	goal_state->next=NULL; 
+	goal_state->hash = hash_state(goal_state, N);
 	
 	return goal_state;
 }
 
 
 /**
- * A simple helper function that allocates memory for fringe
+ * A simple helper function that allocates memory for fringe of the given type
  */
-struct fringe* initialize_fringe(){
+struct fringe* initialize_fringe(fringe_type type){
 	//Allocate memory for the fringe struct
 	struct fringe* fringe = (struct fringe*)malloc(sizeof(struct fringe));
 
 	//Initialize these values
+	fringe->type = type;
 	fringe->fringe_max_size = ARRAY_START_SIZE;
 	fringe->next_fringe_index = 0;
+	fringe->heap = NULL;
+	fringe->buckets = NULL;
+	fringe->num_buckets = 0;
+	fringe->min_bucket = 0;
+
+	//Allocate space for the heap or the buckets
+	if(type == FRINGE_HEAP){
+		fringe->heap = (struct state**)malloc(sizeof(struct state*) * fringe->fringe_max_size);
+	} else {
+		//Every bucket starts out empty, the bucket itself allocates on first use
+		fringe->num_buckets = BUCKET_START_COUNT;
+		fringe->buckets = (struct bucket*)calloc(fringe->num_buckets, sizeof(struct bucket));
+	}
 
-	//Allocate space for the heap
-	fringe->heap = (struct state**)malloc(sizeof(struct state*) * fringe->fringe_max_size);
+	//Allocate space for the membership index, every slot starts out empty
+	fringe->index_max_size = FRINGE_INDEX_START_SIZE;
+	fringe->index = (struct state**)calloc(fringe->index_max_size, sizeof(struct state*));
 
 	//Return a pointer to our fringe in memory
 	return fringe;
@@ -374,45 +869,209 @@ struct closed* initialize_closed(){
 	struct closed* closed = (struct closed*)malloc(sizeof(struct closed));
 	
 	//Initialize these values
-	closed->closed_max_size = ARRAY_START_SIZE;
-	closed->next_closed_index = 0;
+	closed->closed_max_size = CLOSED_START_SIZE;
+	closed->num_states = 0;
 
-	//Reserve space for the internal array
-	closed->array = (struct state**)malloc(sizeof(struct state*) * closed->closed_max_size);
+	//Reserve space for the table, every slot starts out empty
+	closed->array = (struct state**)calloc(closed->closed_max_size, sizeof(struct state*));
+	closed->hashes = (u_int64_t*)malloc(sizeof(u_int64_t) * closed->closed_max_size);
 
 	//Return the closed pointer
 	return closed;
 }
 
 
+/**
+ * Place a state with a known hash into the first free slot of its probe sequence. The caller must
+ * guarantee that there is a free slot
+ */
+static void closed_place(struct closed* closed, struct state* statePtr, u_int64_t hash){
+	//The table size is a power of 2, so a mask gives us the slot
+	u_int64_t mask = closed->closed_max_size - 1;
+	u_int64_t slot = hash & mask;
+
+	//Linear probing until we find an empty slot
+	while(closed->array[slot] != NULL){
+		slot = (slot + 1) & mask;
+	}
+
+	closed->array[slot] = statePtr;
+	closed->hashes[slot] = hash;
+}
+
+
+/**
+ * Double the size of closed and reinsert every state using the saved hashes
+ */
+static void grow_closed(struct closed* closed){
+	//Save the old table
+	struct state** old_array = closed->array;
+	u_int64_t* old_hashes = closed->hashes;
+	int old_size = closed->closed_max_size;
+
+	//Double closed max size and reserve the new table
+	closed->closed_max_size *= 2;
+	closed->array = (struct state**)calloc(closed->closed_max_size, sizeof(struct state*));
+	closed->hashes = (u_int64_t*)malloc(sizeof(u_int64_t) * closed->closed_max_size);
+
+	//Reinsert everything from the old table
+	for(int i = 0; i < old_size; i++){
+		if(old_array[i] != NULL){
+			closed_place(closed, old_array[i], old_hashes[i]);
+		}
+	}
+
+	//The old table is no longer needed
+	free(old_array);
+	free(old_hashes);
+}
+
+
 /**
  * A helper function that merges the given statePtr into closed. This function also automatically
- * resizes closed, so the caller does not have to maintain the array
+ * resizes closed, so the caller does not have to maintain the table. If the state was reopened, it
+ * takes over the slot of its old, more expensive copy
  */
-void merge_to_closed(struct closed* closed, struct state* statePtr){
-	//If we run out of space, we can expand
-	if(closed->next_closed_index == closed->closed_max_size){
-		//Double closed max size
-		closed->closed_max_size *= 2;
-		//Reallocate space for closed
-		closed->array = (struct state**)realloc(closed->array, sizeof(struct state*) * closed->closed_max_size);
+void merge_to_closed(struct closed* closed, struct state* statePtr, const int N){
+	//The table size is a power of 2, so a mask gives us the slot
+	u_int64_t mask = closed->closed_max_size - 1;
+	u_int64_t slot = statePtr->hash & mask;
+
+	//Look for an old copy of this state to replace
+	while(closed->array[slot] != NULL){
+		if(closed->hashes[slot] == statePtr->hash && states_same(closed->array[slot], statePtr, N)){
+			closed->array[slot] = statePtr;
+			return;
+		}
+
+		slot = (slot + 1) & mask;
 	}
 
-	//Put curr_state into closed
-	closed->array[closed->next_closed_index] = statePtr; 
-	//Keep track of the next closed index
-	(closed->next_closed_index)++;
+	//Keep the load factor at or below one half so probe sequences stay short
+	if(2 * (closed->num_states + 1) > closed->closed_max_size){
+		grow_closed(closed);
+	}
 
+	//Put curr_state into closed
+	closed_place(closed, statePtr, statePtr->hash);
+	//Keep track of how many states we have
+	(closed->num_states)++;
 }
 
 
 /**
- * A simple helper function that will swap two pointers in our minHeap
+ * A simple helper function that will swap two pointers in our minHeap. The states also learn their
+ * new positions so that the fringe index stays correct
  */
 static void swap(struct state** a, struct state** b){
 	struct state* temp = *a;
 	*a = *b;
 	*b = temp;
+
+	//Swap the heap positions as well
+	int temp_index = (*a)->heap_index;
+	(*a)->heap_index = (*b)->heap_index;
+	(*b)->heap_index = temp_index;
+}
+
+
+/**
+ * Place a state into the first free slot of its probe sequence in the fringe index
+ */
+static void fringe_index_place(struct fringe* fringe, struct state* statePtr){
+	//The index size is a power of 2, so a mask gives us the slot
+	u_int64_t mask = fringe->index_max_size - 1;
+	u_int64_t slot = statePtr->hash & mask;
+
+	//Linear probing until we find an empty slot
+	while(fringe->index[slot] != NULL){
+		slot = (slot + 1) & mask;
+	}
+
+	fringe->index[slot] = statePtr;
+}
+
+
+/**
+ * Add a state to the fringe index, growing the index if it has become too full
+ */
+static void fringe_index_insert(struct fringe* fringe, struct state* statePtr){
+	//Keep the load factor at or below one half. next_fringe_index already counts the new state
+	if(2 * fringe->next_fringe_index > fringe->index_max_size){
+		//Save the old index
+		struct state** old_index = fringe->index;
+		int old_size = fringe->index_max_size;
+
+		//Double the index size and reserve the new one
+		fringe->index_max_size *= 2;
+		fringe->index = (struct state**)calloc(fringe->index_max_size, sizeof(struct state*));
+
+		//Reinsert everything from the old index
+		for(int i = 0; i < old_size; i++){
+			if(old_index[i] != NULL){
+				fringe_index_place(fringe, old_index[i]);
+			}
+		}
+
+		free(old_index);
+	}
+
+	fringe_index_place(fringe, statePtr);
+}
+
+
+/**
+ * Remove a state from the fringe index. Since we use linear probing, the states after the removed one
+ * are shifted back to fill the hole so that no probe sequence is ever broken
+ */
+static void fringe_index_remove(struct fringe* fringe, struct state* statePtr){
+	u_int64_t mask = fringe->index_max_size - 1;
+	u_int64_t slot = statePtr->hash & mask;
+
+	//Find the slot that holds this exact state
+	while(fringe->index[slot] != statePtr){
+		slot = (slot + 1) & mask;
+	}
+
+	//The hole that needs to be filled
+	u_int64_t hole = slot;
+	u_int64_t home;
+
+	//Walk the rest of the cluster
+	for(slot = (slot + 1) & mask; fringe->index[slot] != NULL; slot = (slot + 1) & mask){
+		//Where this state would like to be
+		home = fringe->index[slot]->hash & mask;
+
+		//If the home slot does not lie cyclically in (hole, slot], this state can move back into the hole
+		if(((slot - home) & mask) >= ((slot - hole) & mask)){
+			fringe->index[hole] = fringe->index[slot];
+			hole = slot;
+		}
+	}
+
+	//The final hole is now empty
+	fringe->index[hole] = NULL;
+}
+
+
+/**
+ * Find the state in the fringe that has the same tiles as statePtr, or NULL if there is none
+ */
+static struct state* fringe_index_lookup(struct fringe* fringe, struct state* statePtr, const int N){
+	u_int64_t mask = fringe->index_max_size - 1;
+	u_int64_t slot = statePtr->hash & mask;
+
+	//Go through the probe sequence until we find an empty slot
+	while(fringe->index[slot] != NULL){
+		if(states_same(fringe->index[slot], statePtr, N)){
+			return fringe->index[slot];
+		}
+
+		slot = (slot + 1) & mask;
+	}
+
+	//Not in the fringe
+	return NULL;
 }
 
 
@@ -424,11 +1083,114 @@ static int parent_index(int index){
 }
 
 
+/**
+ * Find which bucket a state belongs in. The buckets are laid out as a triangle, every total_cost f gets
+ * f + 1 buckets, one for each heuristic_cost from 0 to f. This puts the buckets in priority order: lowest
+ * total_cost first, and for the same total_cost, lowest heuristic_cost(so highest current_travel) first
+ */
+static int bucket_number(struct state* statePtr){
+	return statePtr->total_cost * (statePtr->total_cost + 1) / 2 + statePtr->heuristic_cost;
+}
+
+
+/**
+ * Push a state onto the top of its bucket
+ */
+static void bucket_push(struct fringe* fringe, struct state* statePtr){
+	int number = bucket_number(statePtr);
+
+	//If the total_cost is beyond anything we've seen, grow the bucket array
+	if(number >= fringe->num_buckets){
+		int old_count = fringe->num_buckets;
+
+		//Keep doubling until it fits
+		while(number >= fringe->num_buckets){
+			fringe->num_buckets *= 2;
+		}
+
+		//The new buckets all start out empty
+		fringe->buckets = (struct bucket*)realloc(fringe->buckets, sizeof(struct bucket) * fringe->num_buckets);
+		memset(fringe->buckets + old_count, 0, sizeof(struct bucket) * (fringe->num_buckets - old_count));
+	}
+
+	struct bucket* bucket = &(fringe->buckets[number]);
+
+	//Automatic resize of the bucket itself
+	if(bucket->size == bucket->max_size){
+		bucket->max_size = bucket->max_size == 0 ? 16 : bucket->max_size * 2;
+		bucket->states = (struct state**)realloc(bucket->states, sizeof(struct state*) * bucket->max_size);
+	}
+
+	//Push onto the top, heap_index holds our position in the bucket
+	bucket->states[bucket->size] = statePtr;
+	statePtr->heap_index = bucket->size;
+	(bucket->size)++;
+
+	//The minimum may have moved backwards
+	if(number < fringe->min_bucket){
+		fringe->min_bucket = number;
+	}
+}
+
+
+/**
+ * Take a state out of the middle of its bucket by moving the top state into its place
+ */
+static void bucket_remove(struct fringe* fringe, struct state* statePtr){
+	struct bucket* bucket = &(fringe->buckets[bucket_number(statePtr)]);
+
+	//Move the top of the bucket into the hole
+	(bucket->size)--;
+	bucket->states[statePtr->heap_index] = bucket->states[bucket->size];
+	bucket->states[statePtr->heap_index]->heap_index = statePtr->heap_index;
+}
+
+
+/**
+ * Pop the top state out of the lowest non-empty bucket
+ */
+static struct state* bucket_pop(struct fringe* fringe){
+	//Advance past all of the empty buckets. Since the caller checks fringe_empty, we must find one
+	while(fringe->buckets[fringe->min_bucket].size == 0){
+		(fringe->min_bucket)++;
+	}
+
+	struct bucket* bucket = &(fringe->buckets[fringe->min_bucket]);
+
+	//LIFO, so we take from the top
+	(bucket->size)--;
+	return bucket->states[bucket->size];
+}
+
+
+/**
+ * Move the state at the given index up the heap until its parent has a lower or equal priority
+ */
+static void sift_up(struct fringe* fringe, int current_index){
+	//As long as we're in valid bounds, and the priorities of parent and child are backwards
+	while (current_index > 0 && fringe->heap[parent_index(current_index)]->total_cost > fringe->heap[current_index]->total_cost){
+		//Swap the two values
+		swap(&(fringe->heap[parent_index(current_index)]), &(fringe->heap[current_index]));
+
+		//Set the current index to be it's parent, and repeat the process
+		current_index = parent_index(current_index);
+	}
+}
+
+
 /**
  * States will be merged into fringe according to their priority values. The lower the total cost,
  * the higher the priority. Since fringe is a minHeap, we will insert accordingly
  */
 void priority_queue_insert(struct fringe* fringe, struct state* statePtr){
+	//The bucket queue has no need for any heap work
+	if(fringe->type == FRINGE_BUCKET){
+		bucket_push(fringe, statePtr);
+		(fringe->next_fringe_index)++;
+		fringe_index_insert(fringe, statePtr);
+		return;
+	}
+
 	//Automatic resize
 	if(fringe->next_fringe_index == fringe->fringe_max_size){
 		//Just double this value
@@ -439,20 +1201,15 @@ void priority_queue_insert(struct fringe* fringe, struct state* statePtr){
 
 	//Insert value at the very end
 	fringe->heap[fringe->next_fringe_index] = statePtr;
+	statePtr->heap_index = fringe->next_fringe_index;
 	//Increment the next fringe index
 	(fringe->next_fringe_index)++;
 
-	//The current index will be used to reheapify after this addition
-	int current_index = fringe->next_fringe_index - 1;
-
-	//As long as we're in valid bounds, and the priorities of parent and child are backwards
-	while (current_index > 0 && fringe->heap[parent_index(current_index)]->total_cost > fringe->heap[current_index]->total_cost){
-		//Swap the two values
-		swap(&(fringe->heap[parent_index(current_index)]), &(fringe->heap[current_index]));
+	//Keep the membership index up to date
+	fringe_index_insert(fringe, statePtr);
 
-		//Set the current index to be it's parent, and repeat the process
-		current_index = parent_index(current_index);
-	}
+	//Reheapify after this addition
+	sift_up(fringe, statePtr->heap_index);
 }
 
 
@@ -492,11 +1249,27 @@ static void min_heapify(struct fringe* fringe, int index){
  * replacing it with the very last value, and calling minHeapify()
  */
 struct state* dequeue(struct fringe* fringe){
+	//The bucket queue just pops from its lowest bucket
+	if(fringe->type == FRINGE_BUCKET){
+		struct state* popped = bucket_pop(fringe);
+		(fringe->next_fringe_index)--;
+
+		//The popped state is no longer in the fringe
+		popped->heap_index = -1;
+		fringe_index_remove(fringe, popped);
+		return popped;
+	}
+
 	//Save the pointer, we always take from the front
 	struct state* dequeued = fringe->heap[0];
 	
 	//Put the last element in the front to "prime" the heap
 	fringe->heap[0] = fringe->heap[fringe->next_fringe_index - 1];
+	fringe->heap[0]->heap_index = 0;
+
+	//The dequeued state is no longer in the fringe
+	dequeued->heap_index = -1;
+	fringe_index_remove(fringe, dequeued);
 
 	//Decrement this value
 	(fringe->next_fringe_index)--;
@@ -511,9 +1284,9 @@ struct state* dequeue(struct fringe* fringe){
 
 /**
  * This function generates a starting configuration of appropriate complexity by moving the 0
- * slider around randomly, for an appropriate number of moves
+ * slider around randomly, for an appropriate number of moves. The same seed always gives the same configuration
  */
-struct state* generate_start_config(const int complexity, const int N){
+struct state* generate_start_config(const int complexity, const int N, const u_int64_t seed){
 	//Create the simplified state that we will use for generation
 	struct state* statePtr = (struct state*)malloc(sizeof(struct state));
 	//Iniitialize the state with helper function
@@ -527,54 +1300,55 @@ struct state* generate_start_config(const int complexity, const int N){
 		//Mathematically generate column position for goal by finding remainder of row division
 		col = (index - 1) % N;
 		//Put the index in the correct position
-		*(statePtr->tiles + row * N + col) = index;
+		set_tile(statePtr, row * N + col, index, N);
 	}
 	
 	//Now that we have generated and placed numbers 1-15, we will put the 0 slider in the very last slot
-	*(statePtr->tiles + N * N - 1) = 0;
+	set_tile(statePtr, N * N - 1, 0, N);
 	//Initialize the zero_row and zero_column position for use later
 	statePtr->zero_row = N-1;
 	statePtr->zero_column = N-1;
+	//Hash the goal configuration, the moves below will keep this up to date
+	statePtr->hash = hash_state(statePtr, N);
 
-	//Set the seed for our random number generation
-	srand(time(NULL));
+	//Every puzzle comes from its own generator, so the same seed always makes the same puzzle
+	struct random_generator generator;
+	initialize_random_generator(&generator, seed);
 
-	//Counter for while loop
-	int i = 0;
+	//The move that we just made, which the next one never undoes, so every move makes the puzzle that much more complex
+	int last_move = -1;
+	//The moves that we can choose from
+	int moves[4];
 
-	//A variable to store our random move numbers in
-	int random_move;
 	//The main loop of our program. Keep randomly messing up the goal config as many times as specified
-	//In theory -- higher number inputted = more complex config
-	while(i < complexity){
-		//Get a random number from 0 to 4
-		random_move = rand() % 4;	
-
+	for(int i = 0; i < complexity; i++){
 		//We will keep the same convention as in the solver
 		// 0 = left move, 1 = right move, 2 = down move , 3 = up move
-		
-		//Move left if possible and random_move is 0
-		if(random_move == 0 && statePtr->zero_column > 0){
-			move_left(statePtr, N);
-		}
+		int num_moves = 0;
+		for(int move = 0; move < 4; move++){
+			//Skip undoing the last move, and the moves that would take the blank off of the board
+			if((last_move >= 0 && move == (last_move ^ 1)) || (move == 0 && statePtr->zero_column == 0)
+			   || (move == 1 && statePtr->zero_column == N - 1) || (move == 2 && statePtr->zero_row == N - 1)
+			   || (move == 3 && statePtr->zero_row == 0)){
+				continue;
+			}
 
-		//Move right if possible and random move is 1
-		if(random_move == 1 && statePtr->zero_column < N-1){
-			move_right(statePtr, N);
+			moves[num_moves] = move;
+			num_moves++;
 		}
 
-		//Move down if possible and random move is 2
-		if(random_move == 2 && statePtr->zero_row < N-1){
-			move_down(statePtr, N);
-		}
+		//Even in a corner, there is always one move left over
+		last_move = moves[random_below(&generator, num_moves)];
 
-		//Move up if possible and random move is 3
-		if(random_move == 3 && statePtr->zero_row > 0){
+		if(last_move == 0){
+			move_left(statePtr, N);
+		} else if(last_move == 1){
+			move_right(statePtr, N);
+		} else if(last_move == 2){
+			move_down(statePtr, N);
+		} else {
 			move_up(statePtr, N);
 		}
-
-		//Increment i
-		i++;
 	}
 
 	return statePtr;
@@ -590,9 +1364,37 @@ int fringe_empty(struct fringe* fringe){
 
 
 /**
- * Check to see if the state at position i in the fringe is repeating. If it is, free it and
- * set the pointer to be null
- * NOTE: since we may modify the memory address of statePtr, we need a reference to that address 
+ * Find the copy of a state that is in the fringe, or NULL if it isn't there
+ */
+struct state* find_in_fringe(struct fringe* fringe, struct state* statePtr, const int N){
+	return fringe_index_lookup(fringe, statePtr, N);
+}
+
+
+/**
+ * Look at the state that dequeue would return next, without taking it out of the fringe. The fringe must not be empty
+ */
+struct state* fringe_peek(struct fringe* fringe){
+	if(fringe->type == FRINGE_BUCKET){
+		//Advance past all of the empty buckets, just like bucket_pop
+		while(fringe->buckets[fringe->min_bucket].size == 0){
+			(fringe->min_bucket)++;
+		}
+
+		struct bucket* bucket = &(fringe->buckets[fringe->min_bucket]);
+		return bucket->states[bucket->size - 1];
+	}
+
+	//The heap always has its minimum at the front
+	return fringe->heap[0];
+}
+
+
+/**
+ * Check to see if the state is already in the fringe. If it is and the fringe copy was reached with the same or
+ * a lower current_travel, set the pointer to be null. If the new state has the better current_travel it is kept,
+ * and merge_to_fringe will use it to decrease the key of the fringe copy
+ * NOTE: the state's memory belongs to the caller, so a repeat is never freed here
  */
 void check_repeating_fringe(struct fringe* fringe, struct state** statePtr, const int N){ 	
 	//If succ_states[i] is NULL, no need to check anything
@@ -600,27 +1402,46 @@ void check_repeating_fringe(struct fringe* fringe, struct state** statePtr, cons
 		return;
 	}
 
-	//Go through the heap, if we ever find an element that's the same, break out and free the pointer
-	for(int i = 0; i < fringe->next_fringe_index; i++){
-		//If the states match, we free the pointer and exit the loop
-		if(states_same(*statePtr, fringe->heap[i], N)){
-			//Properly tear down the dynamic array in the state to avoid memory leaks
-			destroy_state(*statePtr);
-			//Free the pointer to the state
-			free(*statePtr);
-			//Set the pointer to be null as a warning
-			*statePtr = NULL;
-			break;
+	//Use the index to find a matching state in O(1)
+	struct state* repeat = fringe_index_lookup(fringe, *statePtr, N);
+
+	//If the states match and the new one is no better, set the pointer to be null as a warning
+	if(repeat != NULL && repeat->current_travel <= (*statePtr)->current_travel){
+		*statePtr = NULL;
+	}
+	//If we get here, we know that the state was either not repeating or is an improvement
+}
+
+
+/**
+ * Find the copy of a state in the closed hash set. We only need to probe from the state's home slot until we hit
+ * an empty slot, so this is O(1) expected no matter how large closed grows. Returns NULL if it isn't there
+ */
+struct state* find_in_closed(struct closed* closed, struct state* statePtr, const int N){
+	//The table size is a power of 2, so a mask gives us the slot
+	u_int64_t mask = closed->closed_max_size - 1;
+	u_int64_t hash = statePtr->hash;
+	u_int64_t slot = hash & mask;
+
+	//Go through the probe sequence until we find an empty slot
+	while(closed->array[slot] != NULL){
+		//Only do the full comparison if the hashes match
+		if(closed->hashes[slot] == hash && states_same(closed->array[slot], statePtr, N)){
+			return closed->array[slot];
 		}
+
+		slot = (slot + 1) & mask;
 	}
-	//If we get here, we know that the state was not repeating
+
+	//Not in closed
+	return NULL;
 }
 
 
 /**
- * Check for repeats in the closed array. Since we don't need any priority queue functionality,
- * using closed as an array is a major speedup for us
- * NOTE: since we may modify the memory address of statePtr, we need a reference to that address 
+ * Check for repeats in the closed hash set. A repeat is only let through if it is a cheaper path than the one
+ * that was expanded
+ * NOTE: the state's memory belongs to the caller, so a repeat is never freed here
  */
 void check_repeating_closed(struct closed* closed, struct state** statePtr, const int N){
 	//If this has already been made null, simply return
@@ -628,128 +1449,111 @@ void check_repeating_closed(struct closed* closed, struct state** statePtr, cons
 		return;
 	}
 
-	//Go through the entire populated closed array
-	for(int i = closed->next_closed_index - 1; i > -1; i--){
-		//If at any point we find that the states are the same
-		if(states_same(closed->array[i], *statePtr, N)){
-			//Free both the internal memory and the state pointer itself
-			destroy_state(*statePtr);
-			free(*statePtr);
-			//Set to null as a warning
-			*statePtr = NULL;
-			//Break out of the loop and exit
-			break;
-		}
+	struct state* repeat = find_in_closed(closed, *statePtr, N);
+
+	//A heuristic that is admissible but not consistent can find a cheaper path to a state after it was
+	//expanded. Such a state is let through so that it gets reopened, anything else is set to null as a warning
+	if(repeat != NULL && repeat->current_travel <= (*statePtr)->current_travel){
+		*statePtr = NULL;
 	}
-	//If we get here, we know that the state was not repeating
+	//If we get here, we know that the state was either not repeating or is an improvement
 }
 
 
 /**
  * This function simply iterates through successors, passing the appropriate states along to priority_queue_insert if the pointers
- * are not null
+ * are not null. If a successor is a cheaper path to a state that is already in the fringe, the fringe copy takes over the
+ * new path and has its key decreased in place instead, and the successor is set to null
  */
-int merge_to_fringe(struct fringe* fringe, struct state* successors[4]){ 
+int merge_to_fringe(struct fringe* fringe, struct state* successors[4], const int N){ 
 	//Keep track of how many valid(not null) successors that we merge in
 	int valid_successors = 0;
+	//For any repeats that we find
+	struct state* repeat;
 
 	//Iterate through succ_states, if the given state is not null, call the priority_queue_insert function on it
 	for(int i = 0; i < 4; i++){
-		if(successors[i] != NULL){
-			//If it isn't null, we also know that we have one more unique config, so increment our counterS
-			valid_successors++;
-			//Insert into queue
-			priority_queue_insert(fringe, successors[i]);
+		if(successors[i] == NULL){
+			continue;
 		}
-	}
-	//Return how many valid successors that we had
-	return valid_successors;
-}
 
+		//check_repeating_fringe only lets repeats through if they are an improvement
+		repeat = fringe_index_lookup(fringe, successors[i], N);
 
-/**
- * A helper function to tell us if state_ptr is in the solution path linked list
- */
-static int in_solution_path(struct state* state_ptr, struct state* solution_path, const int N){
-	//If the solution is null, it can't contain it so return false
-	if(solution_path == NULL){
-		return 0;
-	}
+		//If we have a repeat, the fringe copy inherits the better path and moves up the heap
+		if(repeat != NULL){
+			//In a bucket queue, the key is decreased by moving the state to its new bucket
+			if(fringe->type == FRINGE_BUCKET){
+				bucket_remove(fringe, repeat);
+			}
 
-	//Maintain a cursor
-	struct state* cursor = solution_path;
+			repeat->current_travel = successors[i]->current_travel;
+			repeat->predecessor = successors[i]->predecessor;
+			//Which moves are pruned depends on the path, so that has to come along too
+			repeat->move_state = successors[i]->move_state;
+			//The tiles are the same, so the heuristic_cost is as well. The successor's total_cost is taken as is,
+			//so that a search with its own notion of priority keeps it
+			repeat->total_cost = successors[i]->total_cost;
+
+			if(fringe->type == FRINGE_BUCKET){
+				bucket_push(fringe, repeat);
+			} else {
+				sift_up(fringe, repeat->heap_index);
+			}
 
-	//Iterate over our linked list
-	while(cursor != NULL){
-		//If we have a match, return 1
-		if(states_same(state_ptr, cursor, N) == 1){
-			return 1;
+			//The successor itself is no longer needed, the caller will give its memory back
+			successors[i] = NULL;
+			continue;
 		}
 
-		//Advance the cursor
-		cursor = cursor->next;
+		//If it isn't null, we also know that we have one more unique config, so increment our counterS
+		valid_successors++;
+		//Insert into queue
+		priority_queue_insert(fringe, successors[i]);
 	}
-	
-	//If we get here, we didn't find it
-	return 0;
+	//Return how many valid successors that we had
+	return valid_successors;
 }
 
 
 /**
- * Cleanup the fringe and closed lists when we're done
+ * Cleanup a closed hash set on its own. Like the fringe, the states in it belong to the solver's arena
  */
-void cleanup_fringe_closed(struct fringe* fringe, struct closed* closed, struct state* solution_path, const int N){
-	//cleanup fringe
-	for(int i = 0; i < fringe->next_fringe_index; i++){
-		destroy_state(fringe->heap[i]);
-		free(fringe->heap[i]);
-	}
-
-	//Free the fringe array
-	free(fringe->heap);
-	//Free the fringe struct
-	free(fringe);
-
-	//cleanup closed
-	for(int i = 0; i < closed->next_closed_index; i++){
-		//NOTE: some of the stuff is fringe is in our solution path,
-		//for obvious reasons, if we destroy those states we will have issues
-		//so we must check here
-		if(in_solution_path(closed->array[i], solution_path, N) == 0){
-			destroy_state(closed->array[i]);
-			free(closed->array[i]);
-		}
-	}
-
-	//Free the array of pointers
+void cleanup_closed(struct closed* closed){
+	//Free the table and the saved hashes
 	free(closed->array);
+	free(closed->hashes);
 	//Free the close struct
 	free(closed);
 }
 
 
 /**
- * Define a way of cleaning up the solution path once done with it
+ * Free the fringe, but not the states in it, which all live in the solver's arena
  */
-void cleanup_solution_path(struct state* solution_path){
-	//Assign a cursor for list traversal
-	struct state* cursor = solution_path;
-	struct state* temp;	
+void cleanup_fringe(struct fringe* fringe){
+	//Free the buckets, if we have them
+	for(int i = 0; fringe->type == FRINGE_BUCKET && i < fringe->num_buckets; i++){
+		free(fringe->buckets[i].states);
+	}
 
-	//Iterate over the linked list
-	while(cursor != NULL){
-		//Assign temp to be cursor
-		temp = cursor;
+	//Free the fringe arrays
+	free(fringe->heap);
+	free(fringe->buckets);
+	//Free the membership index
+	free(fringe->index);
+	//Free the fringe struct
+	free(fringe);
+}
 
-		//Advance cursor for the next round
-		cursor = cursor->next;
 
-		//Free the tiles in cursor
-		destroy_state(temp);
-		
-		//Free temp altogether
-		free(temp);
-	}
+/**
+ * Cleanup the fringe and closed structures when we're done. The states themselves all live in the solver's
+ * arena, which releases them all at once, so there is no per-state work to do here
+ */
+void cleanup_fringe_closed(struct fringe* fringe, struct closed* closed){
+	cleanup_fringe(fringe);
+	cleanup_closed(closed);
 }
 
 
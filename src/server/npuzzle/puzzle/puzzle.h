@@ -9,73 +9,186 @@
 #define PUZZLE_H
 
 #define ARRAY_START_SIZE 5000
+//The starting number of slots in the closed hash set, this must always be a power of 2
+#define CLOSED_START_SIZE 8192
+//The starting number of slots in the fringe membership index, this must always be a power of 2
+#define FRINGE_INDEX_START_SIZE 8192
+//The starting number of buckets in a bucket queue fringe, enough for every f value up to 100
+#define BUCKET_START_COUNT 5151
+//Puzzles up to this size are packed into the state itself instead of having a tile array
+#define PACKED_MAX_N 5
+//Puzzles up to this size fit into one 64 bit word, 5x5 puzzles take a second word for their high bits
+#define PACKED_SMALL_MAX_N 4
 
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 #include <stdio.h>
 #include <time.h>
+#include <sys/types.h>
+
+
+/**
+ * A packed set of tiles. Tile i lives in bits [i * w, i * w + w), where w is 4 bits for N <= 4, which fits all
+ * 16 tiles into one 64 bit word, and 5 bits for N = 5, which takes 125 of the 128 bits. Only the 5x5 ever needs
+ * the full width, so states keep the word in two 64 bit halves and this type is only for working on it
+ */
+typedef unsigned __int128 packed_tiles;
 
 
 /**
 * Defines a type of state, which is a structure, that represents a configuration in the gem puzzle game
 */
 struct state {
-   //Define a dynamic 2D array for the tiles since we have a variable puzzle size
-   short* tiles;
-   //For A*, define the total_cost, how far the tile has traveled, and heuristic cost int total_cost, current_travel, heuristic_cost;
-   int total_cost, current_travel, heuristic_cost;
-   //location (row and colum) of blank tile 0
-   short zero_row, zero_column;
+   //The hash of the tiles, kept up to date by the move functions
+   u_int64_t hash;
    //The next state in the linked list(fringe or closed), NOT a successor
    struct state* next;
    //The predecessor of the current state, used for tracing back a solution	
    struct state* predecessor;			
+   //For A*, define the total_cost, how far the tile has traveled, and heuristic cost int total_cost, current_travel, heuristic_cost;
+   int total_cost, current_travel, heuristic_cost;
+   //location (row and colum) of blank tile 0
+   short zero_row, zero_column;
+   //The position of this state in the fringe heap or its fringe bucket, or -1 if it is not in the fringe
+   int heap_index;
+   //Manhattan distance plus linear conflicts, before the walking distance is taken into account. Kept on its own so
+   //that the successors can update it incrementally, whatever heuristic_cost ends up being
+   int base_heuristic_cost;
+   //The encoded walking distance patterns of the rows and the columns, and how many moves each one needs, only used
+   //by the walking distance heuristic
+   u_int64_t walking_rows, walking_columns;
+   short walking_row_cost, walking_column_cost;
+   //Where the move pruning machine is after the path to this state, set by whoever makes the move since copy_state
+   //doesn't know which one it is
+   u_int16_t move_state;
+   //Which search of an anytime solve expanded this state, only used by ARA*. It fits into what was padding
+   u_int16_t search_pass;
+   //Which of these is in use depends on N alone
+   union {
+      //For N <= PACKED_MAX_N, the low 64 bits of the packed tiles, which is all of them for N <= 4
+      u_int64_t packed;
+      //For N > PACKED_MAX_N, a dynamic 2D array for the tiles since we have a variable puzzle size
+      short* tiles;
+   };
+   //The high bits of the packed tiles, only for N = 5. This has to stay last, since the arena leaves it off of the
+   //states of smaller puzzles
+   u_int64_t packed_high;
 };
 
 
 /**
- * Define a struct that holds everything that we need for the closed array
+ * Define a struct that holds everything that we need for the closed hash set. Closed is an open addressing
+ * hash set with linear probing, so membership tests are O(1) expected instead of a scan over every closed state
  */
 struct closed {
+	//The table of slots, an empty slot is NULL
 	struct state** array;
-	int next_closed_index;
+	//The hash of the state in each slot, saved so that we never have to rehash a state
+	u_int64_t* hashes;
+	//How many states are currently in closed
+	int num_states;
+	//How many slots the table has, always a power of 2
 	int closed_max_size;
 };
 
 
 /**
- * Define a struct that holds everything that we need for the fringe min heap
+ * The kinds of fringe that the solver can use
+ */
+typedef enum {
+	//A binary min heap on total_cost, works for any range of total_cost
+	FRINGE_HEAP,
+	//A bucket queue, for when total_cost is a small bounded integer
+	FRINGE_BUCKET
+} fringe_type;
+
+
+/**
+ * The heuristics that the solver can estimate the remaining cost with
+ */
+typedef enum {
+	//Manhattan distance plus linear conflicts, works for any N
+	HEURISTIC_LINEAR_CONFLICT,
+	//The additive pattern database, only for N = 4 and only once it has been loaded
+	HEURISTIC_PATTERN_DATABASE,
+	//The larger of walking distance and linear conflicts, only for N = 4 and N = 5
+	HEURISTIC_WALKING_DISTANCE
+} heuristic_type;
+
+
+/**
+ * A LIFO bucket of states that share the same total_cost and heuristic_cost
+ */
+struct bucket {
+	struct state** states;
+	int size;
+	int max_size;
+};
+
+
+/**
+ * Define a struct that holds everything that we need for the fringe. The fringe is either a min heap, or
+ * a bucket queue with one bucket for every (total_cost, heuristic_cost) pair. Alongside either one, the fringe
+ * keeps a hash index of every state in it, so that a repeat can be found in O(1) and its position in the
+ * heap or bucket can be read straight out of heap_index for a decrease-key
  */
 struct fringe {
+	fringe_type type;
 	struct state** heap;
+	//The number of states in the fringe, for either type
 	int next_fringe_index;
 	int fringe_max_size;
+	//The buckets for the bucket queue, in priority order
+	struct bucket* buckets;
+	int num_buckets;
+	//No bucket before this one has any states in it
+	int min_bucket;
+	//Open addressing index of the states in the heap, an empty slot is NULL
+	struct state** index;
+	//How many slots the index has, always a power of 2
+	int index_max_size;
 };
 
 
 /* Method Protoypes */
 void initialize_state(struct state* state_ptr, const int N);
-void destroy_state(struct state* state_ptr);
-void cleanup_fringe_closed(struct fringe* fringe, struct closed* closed, struct state* state_ptr, const int N);
-void cleanup_solution_path(struct state* solution);
+void destroy_state(struct state* state_ptr, const int N);
+size_t state_size(const int N);
+void cleanup_fringe(struct fringe* fringe);
+void cleanup_fringe_closed(struct fringe* fringe, struct closed* closed);
+void cleanup_closed(struct closed* closed);
 void print_state(struct state* state_ptr, const int N, int option);
 void copy_state(struct state* predecessor, struct state* successor, const int N);
 void move_down(struct state* state_ptr, const int N);
 void move_right(struct state* state_ptr, const int N);
 void move_up(struct state* state_ptr, const int N);
 void move_left(struct state* state_ptr, const int N);
+void initialize_simd_kernels(void);
+const char* simd_kernel_name(void);
 int states_same(struct state* a, struct state* b, const int N);
+u_int64_t hash_state(struct state* state_ptr, const int N);
+short get_tile(struct state* state_ptr, const int index, const int N);
+void set_tile(struct state* state_ptr, const int index, const short tile, const int N);
+void unpack_tiles(struct state* state_ptr, short* tiles, const int N);
+packed_tiles packed_move(packed_tiles packed, const int blank_index, const int tile_index, const int N);
+u_int64_t packed_hash(packed_tiles packed);
 void update_prediction_function(struct state* state_ptr, int N);
+void update_prediction_function_incremental(struct state* state_ptr, const int N);
+void update_heuristic(struct state* state_ptr, const int N, heuristic_type heuristic);
 void priority_queue_insert(struct fringe* fringe, struct state* state_ptr);
 struct state* initialize_goal(const int N);
-struct state* generate_start_config(const int complexity, const int N);
+struct state* generate_start_config(const int complexity, const int N, const u_int64_t seed);
 struct closed* initialize_closed(void);
-struct fringe* initialize_fringe(void);
-void merge_to_closed(struct closed* closed, struct state* state_ptr);
+struct fringe* initialize_fringe(fringe_type type);
+void merge_to_closed(struct closed* closed, struct state* state_ptr, const int N);
 struct state* dequeue(struct fringe* fringe);
 int fringe_empty(struct fringe* fringe);
 void check_repeating_fringe(struct fringe* fringe, struct state** state_ptr, const int N);
 void check_repeating_closed(struct closed* closed, struct state** state_ptr, const int N);
-int merge_to_fringe(struct fringe* fringe, struct state* successors[4]);
+struct state* find_in_closed(struct closed* closed, struct state* state_ptr, const int N);
+struct state* find_in_fringe(struct fringe* fringe, struct state* state_ptr, const int N);
+struct state* fringe_peek(struct fringe* fringe);
+int merge_to_fringe(struct fringe* fringe, struct state* successors[4], const int N);
 
 #endif /* PUZZLE_H */
@@ -0,0 +1,110 @@
+/**
+ * Author: Jack Robbins
+ * This file implements the random number generator that start configurations are made with. It is xoshiro256**,
+ * which is seeded by running the seed through splitmix64, so that even seeds that are close together start off
+ * nowhere near each other
+ */
+
+#include "random_generator.h"
+//For seeding from the clock
+#include <time.h>
+//For seeding from the thread's identity
+#include <pthread.h>
+
+//The generator that every thread draws its new seeds from, and whether it has been seeded yet
+static __thread struct random_generator seed_generator;
+static __thread int seed_generator_ready = 0;
+
+
+/**
+ * Move a splitmix64 generator along, and give back its next number
+ */
+static u_int64_t splitmix64(u_int64_t* state){
+	*state += 0x9e3779b97f4a7c15ULL;
+	u_int64_t key = *state;
+	key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+	return key ^ (key >> 31);
+}
+
+
+/**
+ * Rotate a 64 bit number to the left
+ */
+static u_int64_t rotate_left(const u_int64_t value, const int bits){
+	return (value << bits) | (value >> (64 - bits));
+}
+
+
+/**
+ * Fill in a generator's state from the seed. splitmix64 never gives back 4 zeroes in a row, so the state is valid
+ */
+void initialize_random_generator(struct random_generator* generator, const u_int64_t seed){
+	u_int64_t state = seed;
+
+	for(int i = 0; i < 4; i++){
+		generator->state[i] = splitmix64(&state);
+	}
+}
+
+
+/**
+ * The next 64 random bits from a generator
+ */
+u_int64_t random_next(struct random_generator* generator){
+	u_int64_t* state = generator->state;
+	u_int64_t result = rotate_left(state[1] * 5, 7) * 9;
+	u_int64_t shifted = state[1] << 17;
+
+	state[2] ^= state[0];
+	state[3] ^= state[1];
+	state[1] ^= state[2];
+	state[0] ^= state[3];
+	state[2] ^= shifted;
+	state[3] = rotate_left(state[3], 45);
+
+	return result;
+}
+
+
+/**
+ * A random number below bound. The top 32 bits are scaled up to bound with a multiply, and the few values that would
+ * make some results more likely than others are thrown out and drawn again
+ */
+u_int32_t random_below(struct random_generator* generator, const u_int32_t bound){
+	u_int64_t product = (random_next(generator) >> 32) * bound;
+	u_int32_t low = (u_int32_t)product;
+
+	if(low < bound){
+		//2^32 mod bound, the number of values that have to be thrown out
+		u_int32_t threshold = -bound % bound;
+
+		while(low < threshold){
+			product = (random_next(generator) >> 32) * bound;
+			low = (u_int32_t)product;
+		}
+	}
+
+	return product >> 32;
+}
+
+
+/**
+ * A new seed from this thread's own generator
+ */
+u_int64_t random_seed(void){
+	//The first time on every thread, mix the time down to the nanosecond with the thread, so that no two threads
+	//ever start off the same
+	if(seed_generator_ready == 0){
+		struct timespec now;
+		clock_gettime(CLOCK_REALTIME, &now);
+
+		u_int64_t seed = (u_int64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+		seed ^= rotate_left((u_int64_t)pthread_self(), 32);
+
+		initialize_random_generator(&seed_generator, seed);
+		seed_generator_ready = 1;
+	}
+
+	return random_next(&seed_generator);
+}
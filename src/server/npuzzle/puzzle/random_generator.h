@@ -0,0 +1,42 @@
+/**
+ * Author: Jack Robbins
+ * This header file defines the random number generator that start configurations are made with. Every generator is
+ * its own little piece of state, so no two threads ever share one, and the same seed always gives the same numbers
+ * on every machine. The functions are implemented in random_generator.c
+ */
+
+#ifndef RANDOM_GENERATOR_H
+#define RANDOM_GENERATOR_H
+
+#include <sys/types.h>
+
+/**
+ * A xoshiro256** generator. The state must never be all zeroes, which initialize_random_generator makes sure of
+ */
+struct random_generator {
+	u_int64_t state[4];
+};
+
+
+/**
+ * Get a generator ready to give out the numbers for the given seed
+ */
+void initialize_random_generator(struct random_generator* generator, const u_int64_t seed);
+
+/**
+ * The next 64 random bits from a generator
+ */
+u_int64_t random_next(struct random_generator* generator);
+
+/**
+ * A random number from 0 up to but not including bound, with every one of them just as likely. bound must not be 0
+ */
+u_int32_t random_below(struct random_generator* generator, const u_int32_t bound);
+
+/**
+ * A new seed for anything that wasn't given one. Every thread draws these from a generator of its own, which it
+ * seeds from the clock and its own identity the first time, so this never waits on another thread
+ */
+u_int64_t random_seed(void);
+
+#endif /* RANDOM_GENERATOR_H */
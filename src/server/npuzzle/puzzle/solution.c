@@ -0,0 +1,196 @@
+/**
+ * Author: Jack Robbins
+ * This file implements the compact solution form. A finished search only keeps the state that it started from and
+ * which way the blank went at every step, so what a solve hands back is tiny next to a full state per step, and the
+ * search's own states can all be thrown away as soon as it's done
+ */
+
+#include "solution.h"
+
+/**
+ * Make a standalone copy of a state that isn't linked to anything
+ */
+static struct state* copy_standalone(struct state* statePtr, const int N){
+	struct state* copy = (struct state*)malloc(sizeof(struct state));
+	initialize_state(copy, N);
+	copy_state(statePtr, copy, N);
+
+	//copy_state treats the copy as a successor, so put the real values back
+	copy->current_travel = statePtr->current_travel;
+	copy->heuristic_cost = statePtr->heuristic_cost;
+	copy->total_cost = statePtr->total_cost;
+	copy->predecessor = NULL;
+
+	return copy;
+}
+
+
+/**
+ * Make a solution out of the path that ends at goal_node
+ */
+struct solution* initialize_solution(struct state* goal_node, const int N){
+	struct solution* solution = (struct solution*)malloc(sizeof(struct solution));
+
+	//Every state but the first one took a move to get to
+	solution->num_moves = 0;
+	struct state* cursor = goal_node;
+	while(cursor->predecessor != NULL){
+		(solution->num_moves)++;
+		cursor = cursor->predecessor;
+	}
+
+	//The path goes backwards, so fill the moves in from the back
+	solution->moves = (char*)malloc(solution->num_moves > 0 ? solution->num_moves : 1);
+	int index = solution->num_moves - 1;
+	for(cursor = goal_node; cursor->predecessor != NULL; cursor = cursor->predecessor){
+		struct state* predecessor = cursor->predecessor;
+
+		//Which way the blank went to get from the predecessor to here
+		if(cursor->zero_column < predecessor->zero_column){
+			solution->moves[index] = SOLUTION_MOVE_LEFT;
+		} else if(cursor->zero_column > predecessor->zero_column){
+			solution->moves[index] = SOLUTION_MOVE_RIGHT;
+		} else if(cursor->zero_row > predecessor->zero_row){
+			solution->moves[index] = SOLUTION_MOVE_DOWN;
+		} else {
+			solution->moves[index] = SOLUTION_MOVE_UP;
+		}
+
+		index--;
+	}
+
+	//cursor is the first state of the path now
+	solution->start = copy_standalone(cursor, N);
+	solution->N = N;
+
+	return solution;
+}
+
+
+/**
+ * Make a solution out of a copy of start and a list of moves that was worked out some other way
+ */
+struct solution* initialize_solution_from_moves(struct state* start, char* moves, const int num_moves, const int N){
+	struct solution* solution = (struct solution*)malloc(sizeof(struct solution));
+
+	solution->start = copy_standalone(start, N);
+	solution->start->current_travel = 0;
+	solution->moves = moves;
+	solution->num_moves = num_moves;
+	solution->N = N;
+
+	return solution;
+}
+
+
+/**
+ * Free a solution and everything in it
+ */
+void destroy_solution(struct solution* solution){
+	destroy_state(solution->start, solution->N);
+	free(solution->start);
+	free(solution->moves);
+	free(solution);
+}
+
+
+/**
+ * Make one move of a solution on statePtr, if it can be made
+ */
+int apply_solution_move(struct state* statePtr, const char move, const int N){
+	if(move == SOLUTION_MOVE_LEFT && statePtr->zero_column > 0){
+		move_left(statePtr, N);
+	} else if(move == SOLUTION_MOVE_RIGHT && statePtr->zero_column < N - 1){
+		move_right(statePtr, N);
+	} else if(move == SOLUTION_MOVE_DOWN && statePtr->zero_row < N - 1){
+		move_down(statePtr, N);
+	} else if(move == SOLUTION_MOVE_UP && statePtr->zero_row > 0){
+		move_up(statePtr, N);
+	} else {
+		return -1;
+	}
+
+	return 0;
+}
+
+
+/**
+ * Replay every move of a solution from its start, and give back where it ends up
+ */
+struct state* replay_solution(struct solution* solution, const int N){
+	struct state* end = copy_standalone(solution->start, N);
+
+	for(int i = 0; i < solution->num_moves; i++){
+		if(apply_solution_move(end, solution->moves[i], N) == -1){
+			destroy_state(end, N);
+			free(end);
+			return NULL;
+		}
+	}
+
+	end->current_travel = solution->num_moves;
+	return end;
+}
+
+
+/**
+ * Check that a solution can be played out, and that it ends up at goal_state
+ */
+int verify_solution(struct solution* solution, struct state* goal_state, const int N){
+	struct state* end = replay_solution(solution, N);
+
+	//One of the moves would have taken the blank off of the board
+	if(end == NULL){
+		return 0;
+	}
+
+	int reached = states_same(end, goal_state, N);
+
+	destroy_state(end, N);
+	free(end);
+
+	return reached;
+}
+
+
+/**
+ * Start an iterator off on the first state of a solution
+ */
+void initialize_solution_iterator(struct solution_iterator* iterator, struct solution* solution, const int N){
+	iterator->solution = solution;
+	iterator->step = 0;
+
+	initialize_state(&(iterator->current), N);
+	copy_state(solution->start, &(iterator->current), N);
+	iterator->current.current_travel = 0;
+	iterator->current.predecessor = NULL;
+}
+
+
+/**
+ * Move the iterator on to the next state of its solution
+ */
+int solution_iterator_next(struct solution_iterator* iterator, const int N){
+	//Nothing left
+	if(iterator->step >= iterator->solution->num_moves){
+		return 0;
+	}
+
+	//A move that can't be made ends the iteration early
+	if(apply_solution_move(&(iterator->current), iterator->solution->moves[iterator->step], N) == -1){
+		return 0;
+	}
+
+	(iterator->step)++;
+	iterator->current.current_travel = iterator->step;
+
+	return 1;
+}
+
+
+/**
+ * Free everything that an iterator holds onto
+ */
+void cleanup_solution_iterator(struct solution_iterator* iterator){
+	destroy_state(&(iterator->current), iterator->solution->N);
+}
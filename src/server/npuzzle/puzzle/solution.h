@@ -0,0 +1,94 @@
+/**
+ * Author: Jack Robbins
+ * This header file defines the compact form that the solver gives its solutions back in: a copy of the state that
+ * the solution starts from, and one byte for every move of the blank after that. Every state along the way can be
+ * made again from those by replaying the moves. The functions are implemented in solution.c
+ */
+
+#ifndef SOLUTION_H
+#define SOLUTION_H
+
+//The moves of the blank, as they are written into a solution
+#define SOLUTION_MOVE_LEFT 'L'
+#define SOLUTION_MOVE_RIGHT 'R'
+#define SOLUTION_MOVE_DOWN 'D'
+#define SOLUTION_MOVE_UP 'U'
+
+#include "puzzle.h"
+
+/**
+ * A solution to a puzzle, which takes up one state and one byte for every move no matter how long it is
+ */
+struct solution {
+	//A standalone copy of the state that the solution starts from
+	struct state* start;
+	//Every move of the blank in order, one of the SOLUTION_MOVE letters each. This is not null terminated
+	char* moves;
+	int num_moves;
+	//The size of the puzzle, which the start state needs to be freed
+	int N;
+};
+
+
+/**
+ * Walks through every state of a solution in order, making each one on a single state of its own
+ */
+struct solution_iterator {
+	struct solution* solution;
+	//The state that the iterator is on
+	struct state current;
+	//How many moves it took to get to current
+	int step;
+};
+
+
+/**
+ * Make a solution out of the path that ends at goal_node and is linked back to its start through predecessor.
+ * Nothing on the path is kept, so it can all be freed as soon as this returns
+ */
+struct solution* initialize_solution(struct state* goal_node, const int N);
+
+/**
+ * Make a solution that starts from a copy of start and makes the given moves, which have to be allocated with malloc
+ * and belong to the solution from then on. Nothing is checked, use verify_solution for that
+ */
+struct solution* initialize_solution_from_moves(struct state* start, char* moves, const int num_moves, const int N);
+
+/**
+ * Free a solution and everything in it
+ */
+void destroy_solution(struct solution* solution);
+
+/**
+ * Make one move of a solution on state_ptr. Returns 0 on success, or -1 if the move isn't one of the SOLUTION_MOVE
+ * letters or would take the blank off of the board, in which case state_ptr is left alone
+ */
+int apply_solution_move(struct state* state_ptr, const char move, const int N);
+
+/**
+ * Replay every move of a solution from its start. Returns a newly allocated state where it ends up, or NULL if one
+ * of the moves can't be made
+ */
+struct state* replay_solution(struct solution* solution, const int N);
+
+/**
+ * Returns 1 if every move of a solution can be made and it ends up at goal_state, 0 otherwise
+ */
+int verify_solution(struct solution* solution, struct state* goal_state, const int N);
+
+/**
+ * Start an iterator off on the first state of a solution
+ */
+void initialize_solution_iterator(struct solution_iterator* iterator, struct solution* solution, const int N);
+
+/**
+ * Move the iterator on to the next state of its solution. Returns 1 if it did, or 0 if it was already at the end
+ */
+int solution_iterator_next(struct solution_iterator* iterator, const int N);
+
+/**
+ * Free everything that an iterator holds onto. The solution itself is left alone
+ */
+void cleanup_solution_iterator(struct solution_iterator* iterator);
+
+#endif /* SOLUTION_H */
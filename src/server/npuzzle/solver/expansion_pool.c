@@ -0,0 +1,148 @@
+/**
+ * Author: Jack Robbins
+ * This c file contains the implementation of the expansion pool defined in expansion_pool.h
+ */
+
+#include "expansion_pool.h"
+#include <stdlib.h>
+#include <unistd.h>
+
+//The pool is created exactly once per process
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+
+//The worker threads
+static pthread_t* workers;
+static int num_workers;
+
+//The task queue is a ring buffer, protected by the pool mutex
+static struct expansion_task* queue;
+static int queue_capacity;
+static int queue_head;
+static int queue_size;
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_has_work = PTHREAD_COND_INITIALIZER;
+
+
+/**
+ * The thread function for every worker in the pool. Workers live for the entire process, taking tasks
+ * off of the queue and counting down the latch of the solve that submitted them
+ */
+static void* pool_worker(void* unused){
+	(void)unused;
+	struct expansion_task task;
+
+	while(1){
+		//Wait for a task to show up
+		pthread_mutex_lock(&pool_mutex);
+		while(queue_size == 0){
+			pthread_cond_wait(&pool_has_work, &pool_mutex);
+		}
+
+		//Take it off of the front of the queue
+		task = queue[queue_head];
+		queue_head = (queue_head + 1) % queue_capacity;
+		queue_size--;
+		pthread_mutex_unlock(&pool_mutex);
+
+		//Do the actual work outside of the lock
+		task.function(task.argument);
+
+		//Count down the latch, and wake the submitter if we were the last one
+		pthread_mutex_lock(&(task.latch->mutex));
+		task.latch->remaining--;
+		if(task.latch->remaining == 0){
+			pthread_cond_signal(&(task.latch->done));
+		}
+		pthread_mutex_unlock(&(task.latch->mutex));
+	}
+
+	return NULL;
+}
+
+
+/**
+ * Create the pool. We use one worker per core, but never fewer than 4 so that a single expansion
+ * can always have all of its moves generated at once
+ */
+static void initialize_expansion_pool(void){
+	num_workers = sysconf(_SC_NPROCESSORS_ONLN);
+	if(num_workers < 4){
+		num_workers = 4;
+	}
+
+	//Reserve the queue
+	queue_capacity = num_workers * TASKS_PER_WORKER;
+	queue = (struct expansion_task*)malloc(sizeof(struct expansion_task) * queue_capacity);
+	queue_head = 0;
+	queue_size = 0;
+
+	//Spawn all of the workers, they are never joined
+	workers = (pthread_t*)malloc(sizeof(pthread_t) * num_workers);
+	for(int i = 0; i < num_workers; i++){
+		pthread_create(&workers[i], NULL, pool_worker, NULL);
+		pthread_detach(workers[i]);
+	}
+}
+
+
+/**
+ * Run function on every one of the arguments using the pool's workers, and only return once they've all
+ * been run. The calling thread runs the last task itself. If the queue doesn't have room for all of the
+ * other tasks, the pool is saturated, so we return 0 without running anything and let the caller do the
+ * work inline
+ */
+int run_on_expansion_pool(void (*function)(void*), void** arguments, int num_tasks){
+	//Create the pool if this is the first call in the process
+	pthread_once(&pool_once, initialize_expansion_pool);
+
+	//With one task or less, handing off would only cost us time
+	if(num_tasks <= 1){
+		if(num_tasks == 1){
+			function(arguments[0]);
+		}
+		return 1;
+	}
+
+	//The last task is run by the caller itself instead of sitting idle, so only the rest go to the pool
+	int num_handed_off = num_tasks - 1;
+
+	//The latch lives on our stack, since we don't return until it opens
+	struct expansion_latch latch;
+	latch.remaining = num_handed_off;
+	pthread_mutex_init(&(latch.mutex), NULL);
+	pthread_cond_init(&(latch.done), NULL);
+
+	pthread_mutex_lock(&pool_mutex);
+
+	//If there isn't room for every task, the pool is saturated
+	if(queue_size + num_handed_off > queue_capacity){
+		pthread_mutex_unlock(&pool_mutex);
+		pthread_mutex_destroy(&(latch.mutex));
+		pthread_cond_destroy(&(latch.done));
+		return 0;
+	}
+
+	//Put every task onto the back of the queue
+	for(int i = 0; i < num_handed_off; i++){
+		queue[(queue_head + queue_size) % queue_capacity] = (struct expansion_task){function, arguments[i], &latch};
+		queue_size++;
+	}
+
+	//Wake up enough workers for all of the tasks
+	pthread_cond_broadcast(&pool_has_work);
+	pthread_mutex_unlock(&pool_mutex);
+
+	//Do our own share of the work while the workers do theirs
+	function(arguments[num_handed_off]);
+
+	//Wait for the latch to open
+	pthread_mutex_lock(&(latch.mutex));
+	while(latch.remaining > 0){
+		pthread_cond_wait(&(latch.done), &(latch.mutex));
+	}
+	pthread_mutex_unlock(&(latch.mutex));
+
+	pthread_mutex_destroy(&(latch.mutex));
+	pthread_cond_destroy(&(latch.done));
+	return 1;
+}
@@ -0,0 +1,42 @@
+/**
+ * Author: Jack Robbins
+ * This header file defines the expansion pool, a process-wide pool of long-lived worker threads that
+ * the solver hands successor generation off to. The functions are implemented in expansion_pool.c
+ */
+
+#ifndef EXPANSION_POOL_H
+#define EXPANSION_POOL_H
+
+//How many tasks may be waiting in the pool per worker before we consider the pool saturated
+#define TASKS_PER_WORKER 2
+
+#include <pthread.h>
+
+/**
+ * A latch that the submitting thread waits on until every one of its tasks has been run
+ */
+struct expansion_latch {
+	int remaining;
+	pthread_mutex_t mutex;
+	pthread_cond_t done;
+};
+
+
+/**
+ * One unit of work for the pool
+ */
+struct expansion_task {
+	void (*function)(void*);
+	void* argument;
+	struct expansion_latch* latch;
+};
+
+
+/**
+ * Run function on every one of the arguments using the pool's workers, and only return once they've all
+ * been run. The pool is created on the first call and shared by every solve in the process. If the pool
+ * is saturated nothing is run, and 0 is returned so that the caller can do the work itself
+ */
+int run_on_expansion_pool(void (*function)(void*), void** arguments, int num_tasks);
+
+#endif /* EXPANSION_POOL_H */
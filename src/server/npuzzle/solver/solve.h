@@ -8,6 +8,12 @@
 
 //Link to puzzle header file 
 #include "../puzzle/puzzle.h"
+//Every solve allocates its states from an arena
+#include "../arena/arena.h"
+//And gives back its solution as a list of moves
+#include "../puzzle/solution.h"
+//The moves that never need to be made are pruned before any successor is made for them
+#include "../puzzle/move_pruning.h"
 /**
  * Define a structure for holding all of our thread parameters. We will only be using the multithreaded 
  * version of the solver
@@ -24,10 +30,97 @@ struct thread_params {
 	//The closed and fringe
 	struct fringe* fringe;
 	struct closed* closed;
+	//The heuristic to estimate the remaining cost with
+	heuristic_type heuristic;
 };
 
 
-//The solve function. In theory, this is the only thing that we should need to see from solver
-struct state* solve(int N, struct state* start_state, struct state* goal_state, int solver_mode);
+/**
+ * The ways that the solver can generate the successors of a state
+ */
+typedef enum {
+	//Spawn and join a new thread for each of the 4 moves, for every expansion
+	EXPANSION_THREAD_PER_MOVE,
+	//Hand the moves off to the process-wide expansion pool, or do them inline if the pool is saturated
+	EXPANSION_POOL,
+	//Generate the moves one after the other on the solver's own thread
+	EXPANSION_INLINE
+} expansion_mode;
+
+
+/**
+ * The search algorithms that the solver can run
+ */
+typedef enum {
+	//A* with a fringe and closed set, fast but its memory grows with every state it sees
+	SOLVER_ENGINE_ASTAR,
+	//IDA*, slower than A* but its memory is bounded by a fixed size transposition table, so it's only run when asked for
+	SOLVER_ENGINE_IDA,
+	//HDA*, a parallel A* that splits the states between one worker per core by their hash
+	SOLVER_ENGINE_HDA,
+	//MM, a bidirectional search from both the start and the goal that meets in the middle
+	SOLVER_ENGINE_BIDIRECTIONAL,
+	//ARA*, which finds a solution quickly and then improves it until its time budget runs out, so the solution
+	//may not be optimal
+	SOLVER_ENGINE_ANYTIME,
+	//PEA*, which finds the same solutions as A* but only keeps the successors that are as promising as the state
+	//they came from, so its fringe holds far fewer states at the price of expanding some states more than once
+	SOLVER_ENGINE_PARTIAL_EXPANSION,
+	//Places the top row and left column over and over, and leaves the last 3x3 to the distance table. Never searches
+	//the full puzzle, so its solutions are far from optimal, but it's the only thing fast enough for the biggest puzzles
+	SOLVER_ENGINE_REDUCTION,
+	//Only for the 3x3, follows the best moves out of a table that was built ahead of time for every layout of the
+	//tiles, so it finds an optimal solution without searching at all
+	SOLVER_ENGINE_TABLE
+} solver_engine;
+
+
+/**
+ * Running statistics that the solver fills in as it goes
+ */
+struct solver_statistics {
+	//How many states were expanded, and how many unique states were generated
+	long expanded;
+	long generated;
+	//The wall time and CPU time spent, in seconds
+	double wall_time;
+	double cpu_time;
+	//The most that the solution can be longer than optimal by, as a factor. Only the anytime and reduction
+	//engines can give back a solution that isn't optimal, every other one always leaves this at 1
+	double suboptimality_bound;
+};
+
+
+/**
+ * Define a structure for all of the choices that the solver can make. Use default_solver_options
+ * to get the right choices for a given N
+ */
+struct solver_options {
+	//The search algorithm to run
+	solver_engine engine;
+	//The kind of fringe that the A* main loop uses
+	fringe_type fringe;
+	//How successors are generated
+	expansion_mode expansion;
+	//The heuristic that every state is estimated with
+	heuristic_type heuristic;
+	//Which moves are pruned before their successors are made
+	move_pruning_type pruning;
+	//How many workers HDA* runs with, 0 means one for every processor. Either way, it gets no more than the processors
+	//that the other HDA* searches in the process leave free
+	int threads;
+	//How long the anytime engine may keep improving its solution for, in seconds. 0 means until it's optimal
+	double time_budget;
+	//Filled in by the solver once it's done
+	struct solver_statistics statistics;
+};
+
+
+//Get the solver options that are best suited for a puzzle of size N
+struct solver_options default_solver_options(const int N);
+
+//The solve function. In theory, this is the only thing that we should need to see from solver. The solution that it
+//gives back belongs to the caller, who frees it with destroy_solution
+struct solution* solve(int N, struct state* start_state, struct state* goal_state, int solver_mode, struct solver_options* options);
 
 #endif /* SOLVER_H */
@@ -0,0 +1,349 @@
+/**
+ * Author: Jack Robbins
+ * This file implements anytime repairing A* (ARA*). A weighted A* orders its fringe by current_travel plus the
+ * heuristic_cost times a weight, which finds a solution far faster than A* does, at the price of it being up to
+ * weight times longer than optimal. ARA* runs a series of these searches with a lower and lower weight, and every
+ * one of them picks up where the last one left off instead of starting over.
+ *
+ * Closed keeps the cheapest path to every state that any search has expanded, so nothing is expanded twice unless
+ * it's reached more cheaply. Within one search, a state that it already expanded isn't expanded again even then. It
+ * is set aside, and only goes back into the fringe for the next search. Every search stops as soon as nothing left
+ * in the fringe could beat the best solution so far, which is then at most weight times optimal. Once the time
+ * budget runs out, we stop with the best solution that we have, and the states that are left over give a bound on
+ * how far from optimal it can be
+ */
+
+//For INT_MAX
+#include <limits.h>
+#include "solve_anytime.h"
+
+/**
+ * Work out the weighted priority of a state, and store it in total_cost so that the fringe orders by it
+ */
+static void set_priority(struct anytime_search* search, struct state* statePtr){
+	statePtr->total_cost = statePtr->current_travel * ANYTIME_WEIGHT_SCALE + search->weight * statePtr->heuristic_cost;
+}
+
+
+/**
+ * How much of its budget the search has used up, as a fraction. That is whichever of its time or its memory is
+ * closer to running out, so the search is out of budget once this reaches 1
+ */
+static double budget_used(struct anytime_search* search){
+	double used = (double)search->generated / search->state_limit;
+
+	//No time budget means that we can take as long as we need to
+	if(search->time_budget <= 0){
+		return used;
+	}
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	double elapsed = (now.tv_sec - search->start_time.tv_sec) + (now.tv_nsec - search->start_time.tv_nsec) / 1e9;
+
+	return elapsed / search->time_budget > used ? elapsed / search->time_budget : used;
+}
+
+
+/**
+ * Generate every successor of statePtr. Anything that can't beat the incumbent is dropped, a goal becomes the
+ * incumbent, cheaper paths to closed states are set aside for the next search, and everything else is merged into
+ * the fringe
+ * 0 = left move, 1 = right move, 2 = down move, 3 = up move
+ */
+static void expand_state(struct anytime_search* search, struct state* statePtr){
+	int N = search->N;
+
+	for(int move = 0; move < 4; move++){
+		//Skip the moves that would take the blank off of the board
+		if((move == 0 && statePtr->zero_column == 0) || (move == 1 && statePtr->zero_column == N - 1)
+		   || (move == 2 && statePtr->zero_row == N - 1) || (move == 3 && statePtr->zero_row == 0)){
+			continue;
+		}
+
+		//A pruned move, like undoing the last one, would only ever lead to a repeat, so don't make it at all
+		int move_state = next_move_state(search->machine, statePtr->move_state, move);
+		if(move_state == MOVE_PRUNED){
+			continue;
+		}
+
+		struct state* successor = arena_allocate_state(search->arena);
+		copy_state(statePtr, successor, N);
+		successor->move_state = move_state;
+
+		if(move == 0){
+			move_left(successor, N);
+		} else if(move == 1){
+			move_right(successor, N);
+		} else if(move == 2){
+			move_down(successor, N);
+		} else {
+			move_up(successor, N);
+		}
+
+		update_heuristic(successor, N, search->heuristic);
+
+		//Nothing that can't beat the incumbent is worth keeping
+		if(successor->current_travel + successor->heuristic_cost >= search->incumbent_cost){
+			arena_release_state(search->arena, successor);
+			continue;
+		}
+
+		//A goal is never expanded, it just becomes the incumbent. We already know that it's the best one so far
+		if(states_same(successor, search->goal_state, N)){
+			search->incumbent = successor;
+			search->incumbent_cost = successor->current_travel;
+			continue;
+		}
+
+		//A path to a state that was already expanded is only worth anything if it's cheaper
+		struct state* closed_copy = find_in_closed(search->closed, successor, N);
+		if(closed_copy != NULL && closed_copy->current_travel <= successor->current_travel){
+			arena_release_state(search->arena, successor);
+			continue;
+		}
+
+		//A cheaper path to a state that this search already expanded waits for the next search
+		if(closed_copy != NULL && closed_copy->search_pass == search->pass){
+			struct state* waiting = find_in_closed(search->inconsistent, successor, N);
+
+			if(waiting == NULL || waiting->current_travel > successor->current_travel){
+				//The one that was waiting was never expanded, so nothing else points to it
+				merge_to_closed(search->inconsistent, successor, N);
+				if(waiting != NULL){
+					arena_release_state(search->arena, waiting);
+				} else {
+					search->generated++;
+				}
+				continue;
+			}
+
+			arena_release_state(search->arena, successor);
+			continue;
+		}
+
+		//Everything else goes into the fringe, unless the fringe already has it at least as cheaply. That includes a
+		//cheaper path to a state that an earlier search expanded, whose copy in closed is replaced once it's expanded
+		set_priority(search, successor);
+		struct state* successors[4] = {successor, NULL, NULL, NULL};
+		check_repeating_fringe(search->open, &(successors[0]), N);
+
+		if(successors[0] == NULL){
+			arena_release_state(search->arena, successor);
+			continue;
+		}
+
+		//If this was a cheaper path to a state in the fringe, the fringe copy takes it over
+		int inserted = merge_to_fringe(search->open, successors, N);
+		search->generated += inserted;
+
+		if(inserted == 0){
+			arena_release_state(search->arena, successor);
+		}
+	}
+}
+
+
+/**
+ * Set up the next search with the current weight. Everything left in the fringe and everything that was set aside
+ * goes into a fresh fringe with its new priority, unless it can't beat the incumbent. Closed is kept as it is, and
+ * only stops counting as expanded by this search
+ */
+static void start_next_search(struct anytime_search* search){
+	struct fringe* open = initialize_fringe(FRINGE_HEAP);
+
+	for(int i = 0; i < search->open->next_fringe_index; i++){
+		struct state* waiting = search->open->heap[i];
+		if(waiting->current_travel + waiting->heuristic_cost < search->incumbent_cost){
+			set_priority(search, waiting);
+			priority_queue_insert(open, waiting);
+		}
+	}
+
+	for(int i = 0; i < search->inconsistent->closed_max_size; i++){
+		struct state* waiting = search->inconsistent->array[i];
+		if(waiting != NULL && waiting->current_travel + waiting->heuristic_cost < search->incumbent_cost){
+			set_priority(search, waiting);
+			priority_queue_insert(open, waiting);
+		}
+	}
+
+	cleanup_fringe(search->open);
+	cleanup_closed(search->inconsistent);
+
+	search->open = open;
+	search->inconsistent = initialize_closed();
+	(search->pass)++;
+}
+
+
+/**
+ * Run one weighted search, until nothing left in the fringe can beat the incumbent. Returns 1 if it got that far,
+ * or 0 if it ran out of budget first. While there is no incumbent yet, the weight is doubled every time another
+ * part of the budget is used up, so that the first solution comes within the budget if at all possible
+ */
+static int improve_path(struct anytime_search* search, int solver_mode){
+	while(!fringe_empty(search->open)){
+		//A goal has a heuristic_cost of 0, so this is the incumbent's own priority
+		if(search->incumbent != NULL && fringe_peek(search->open)->total_cost >= search->incumbent_cost * ANYTIME_WEIGHT_SCALE){
+			return 1;
+		}
+
+		if(search->expanded % ANYTIME_CHECK_INTERVAL == 0){
+			double used = budget_used(search);
+
+			if(used >= 1.0){
+				return 0;
+			}
+
+			//Still no solution, so search more greedily
+			if(search->incumbent == NULL && search->escalations < ANYTIME_ESCALATIONS
+			   && used * (ANYTIME_ESCALATIONS + 1) >= search->escalations + 1){
+				(search->escalations)++;
+				search->weight *= 2;
+				start_next_search(search);
+
+				if(solver_mode == 1){
+					printf("No solution yet, raising the weight to %.1f\n", (double)search->weight / ANYTIME_WEIGHT_SCALE);
+				}
+			}
+		}
+
+		struct state* curr_state = dequeue(search->open);
+		//This replaces any copy that an earlier search expanded, which was always reached less cheaply
+		curr_state->search_pass = search->pass;
+		merge_to_closed(search->closed, curr_state, search->N);
+		expand_state(search, curr_state);
+		search->expanded++;
+
+		//For very complex problems, print the iteration count to the console for a sanity check
+		if(solver_mode == 1 && search->expanded % 1000 == 0){
+			printf("Iteration: %6ld, %6ld total unique states generated\n", search->expanded, search->generated);
+		}
+	}
+
+	return 1;
+}
+
+
+/**
+ * The lowest current_travel + heuristic_cost of every state that is still waiting to be expanded. Every heuristic that
+ * the solver has only counts moves that have to be made, linear conflicts included, so no solution can be shorter
+ * than this. It is never more than the incumbent's length
+ */
+static int lower_bound(struct anytime_search* search){
+	int lowest = search->incumbent_cost;
+
+	//Anytime search always uses the heap, so the fringe can be read in any order straight out of it
+	for(int i = 0; i < search->open->next_fringe_index; i++){
+		struct state* waiting = search->open->heap[i];
+		if(waiting->current_travel + waiting->heuristic_cost < lowest){
+			lowest = waiting->current_travel + waiting->heuristic_cost;
+		}
+	}
+
+	for(int i = 0; i < search->inconsistent->closed_max_size; i++){
+		struct state* waiting = search->inconsistent->array[i];
+		if(waiting != NULL && waiting->current_travel + waiting->heuristic_cost < lowest){
+			lowest = waiting->current_travel + waiting->heuristic_cost;
+		}
+	}
+
+	return lowest;
+}
+
+
+/**
+ * Run ARA* from start, lowering the weight after every search, until the solution is proven optimal or the budget
+ * runs out
+ */
+struct state* anytime_search(struct state_arena* arena, struct state* start, struct state* goal_state, const int N,
+							 int solver_mode, struct solver_options* options){
+	struct anytime_search search;
+
+	//If we're already there, there's nothing to search
+	if(states_same(start, goal_state, N)){
+		options->statistics.expanded = 0;
+		options->statistics.generated = 0;
+		options->statistics.suboptimality_bound = 1.0;
+		return start;
+	}
+
+	search.arena = arena;
+	search.goal_state = goal_state;
+	search.N = N;
+	search.heuristic = options->heuristic;
+	search.machine = move_pruning_machine(N, options->pruning);
+	search.weight = ANYTIME_INITIAL_WEIGHT;
+	search.escalations = 0;
+	search.pass = 0;
+	search.incumbent = NULL;
+	search.incumbent_cost = INT_MAX;
+	search.time_budget = options->time_budget;
+	//Packed states have no tile array
+	search.state_limit = ANYTIME_MEMORY_LIMIT / state_size(N);
+	search.expanded = 0;
+	search.generated = 0;
+	clock_gettime(CLOCK_MONOTONIC, &(search.start_time));
+
+	//The weighted priorities cover far too wide a range for the bucket queue
+	search.open = initialize_fringe(FRINGE_HEAP);
+	search.closed = initialize_closed();
+	search.inconsistent = initialize_closed();
+
+	set_priority(&search, start);
+	priority_queue_insert(search.open, start);
+
+	//How far off of optimal the incumbent can be, as a factor
+	double bound = 0;
+
+	while(1){
+		int finished = improve_path(&search, solver_mode);
+
+		//The fringe ran dry or the budget ran out without ever finding the goal
+		if(search.incumbent == NULL){
+			if(solver_mode == 1 && finished == 0){
+				printf("No solution found within the budget\n");
+			}
+			break;
+		}
+
+		//No solution can be shorter than what is left over. If the search finished, the weight bounds it as well, since
+		//the unweighted heuristic never overestimates
+		bound = (double)search.incumbent_cost / lower_bound(&search);
+		if(finished == 1 && (double)search.weight / ANYTIME_WEIGHT_SCALE < bound){
+			bound = (double)search.weight / ANYTIME_WEIGHT_SCALE;
+		}
+
+		if(solver_mode == 1){
+			printf("Weight %.1f: solution of length %d, at most %.2f times optimal\n",
+				   (double)search.weight / ANYTIME_WEIGHT_SCALE, search.incumbent_cost, bound);
+		}
+
+		//Stop once it's proven optimal, or once we're out of time or memory
+		if(bound <= 1.0 || finished == 0 || budget_used(&search) >= 1.0){
+			break;
+		}
+
+		//Lower the weight for the next search, straight down to the bound if that's lower still
+		search.weight -= ANYTIME_WEIGHT_STEP;
+		if(search.weight > (int)(bound * ANYTIME_WEIGHT_SCALE)){
+			search.weight = bound * ANYTIME_WEIGHT_SCALE;
+		}
+		if(search.weight < ANYTIME_WEIGHT_SCALE){
+			search.weight = ANYTIME_WEIGHT_SCALE;
+		}
+
+		start_next_search(&search);
+	}
+
+	options->statistics.expanded = search.expanded;
+	options->statistics.generated = search.generated;
+	//Without a solution there is nothing to bound, so leave it at optimal
+	options->statistics.suboptimality_bound = bound > 1.0 ? bound : 1.0;
+
+	cleanup_fringe_closed(search.open, search.closed);
+	cleanup_closed(search.inconsistent);
+
+	return search.incumbent;
+}
@@ -0,0 +1,76 @@
+/**
+ * Author: Jack Robbins
+ * This header file defines the anytime engine, which runs anytime repairing A* (ARA*). It finds a first solution
+ * quickly with a heavily weighted heuristic, then keeps lowering the weight and improving the solution for as long
+ * as its time budget allows. The functions are implemented in solve_anytime.c
+ */
+
+#ifndef SOLVE_ANYTIME_H
+#define SOLVE_ANYTIME_H
+
+//Weights are kept in tenths, so that the weighted priorities are still integers
+#define ANYTIME_WEIGHT_SCALE 10
+//The weight of the first search, and how much it drops by for every search after that, in tenths
+#define ANYTIME_INITIAL_WEIGHT 30
+#define ANYTIME_WEIGHT_STEP 5
+//How many expansions go by between looks at the clock
+#define ANYTIME_CHECK_INTERVAL 1024
+//How much memory the states of one search may take up, in bytes. Once they reach it, the search stops improving and
+//keeps what it has
+#define ANYTIME_MEMORY_LIMIT ((long)512 << 20)
+//How many times the weight may be doubled while the first solution is slow in coming. The budget is split into
+//one more part than this, and each part that goes by without a solution doubles it once
+#define ANYTIME_ESCALATIONS 4
+//The time budget that default_solver_options gives every anytime solve, in seconds
+#define ANYTIME_DEFAULT_TIME_BUDGET 10.0
+
+//For the time budget
+#include <time.h>
+#include "solve.h"
+
+/**
+ * Everything that one anytime search keeps track of
+ */
+struct anytime_search {
+	struct state_arena* arena;
+	struct state* goal_state;
+	int N;
+	heuristic_type heuristic;
+	//The moves that are never worth making
+	const struct move_pruning_machine* machine;
+	//The weight of the current search, in tenths, and how many times it's been doubled
+	int weight;
+	int escalations;
+	//OPEN is ordered by current_travel + weight * heuristic_cost, which is stored in total_cost
+	struct fringe* open;
+	//The cheapest path that any search so far has expanded every state with. It's kept from one search to the next, so
+	//a state is only ever expanded again once it's been reached more cheaply
+	struct closed* closed;
+	//Which search this is. The states that it has expanded are stamped with it, which is all that has to change when
+	//the next one starts
+	int pass;
+	//Closed states that were later reached more cheaply. They wait here until the next search instead of
+	//being expanded again, which is what keeps every search after the first one fast
+	struct closed* inconsistent;
+	//The best solution found so far, and its length
+	struct state* incumbent;
+	int incumbent_cost;
+	//When the search started, how long it may run for, and how many states it may generate
+	struct timespec start_time;
+	double time_budget;
+	long state_limit;
+	long expanded;
+	long generated;
+};
+
+
+/**
+ * Run ARA* from start, whose costs must already be filled in, until its budget runs out or its solution is proven
+ * optimal. Every state comes from the arena, and the one that is returned is linked back to start through
+ * predecessor. The most that the solution can be off of optimal by, as a factor, is put into the statistics.
+ * Returns NULL if there is no solution, or if none could be found within the budget
+ */
+struct state* anytime_search(struct state_arena* arena, struct state* start, struct state* goal_state, const int N,
+							 int solver_mode, struct solver_options* options);
+
+#endif /* SOLVE_ANYTIME_H */
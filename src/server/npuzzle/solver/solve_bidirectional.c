@@ -0,0 +1,357 @@
+/**
+ * Author: Jack Robbins
+ * This file implements MM, a bidirectional heuristic search that is guaranteed to meet in the middle. The forward
+ * direction searches from the start state towards the goal with the solver's usual heuristic, and the backward
+ * direction searches from the goal towards the start state with linear conflicts, worked out as if the tiles had been
+ * relabeled so that the start state is the goal.
+ *
+ * Both directions order their fringes by the priority max(f, 2g), which keeps either one from searching past the
+ * midpoint of the optimal path. Every generated state is looked up in the other direction, and the cheapest meeting
+ * found so far is remembered. Once that is no more than the smallest priority left in either fringe, no other
+ * meeting can beat it, and the two half paths are spliced together
+ */
+
+//For INT_MAX
+#include <limits.h>
+#include "solve_bidirectional.h"
+
+/**
+ * Work out the priority of a state from its costs, which is max(f, 2g). It is stored in total_cost, so that the
+ * fringes order the states by it without knowing anything about it
+ */
+static void set_priority(struct state* statePtr){
+	int f = statePtr->current_travel + statePtr->heuristic_cost;
+	int twice_travel = 2 * statePtr->current_travel;
+
+	statePtr->total_cost = f > twice_travel ? f : twice_travel;
+}
+
+
+/**
+ * The manhattan distance of a single tile from where it is in the start state
+ */
+static int start_distance(struct bidirectional_search* search, const short tile, const int row, const int column){
+	return abs(row - search->start_row[tile]) + abs(column - search->start_column[tile]);
+}
+
+
+/**
+ * Count how many tiles would have to leave one row, or one column, for every tile left in it that belongs there to
+ * be in the same order as in the start state. Each of them takes at least 2 moves more than its manhattan distance
+ */
+static int start_line_conflicts(struct bidirectional_search* search, struct state* statePtr, const int line,
+								const int is_row){
+	int N = search->N;
+	//Where each of the tiles that belongs in this line goes along it, in the order that they are in now
+	int* goals = search->line_goals;
+	int num_goals = 0;
+
+	for(int i = 0; i < N; i++){
+		short tile = get_tile(statePtr, is_row == 1 ? line * N + i : i * N + line, N);
+
+		//The blank and any tile that belongs in another line are irrelevant
+		if(tile == 0 || (is_row == 1 ? search->start_row[tile] : search->start_column[tile]) != line){
+			continue;
+		}
+
+		goals[num_goals] = is_row == 1 ? search->start_column[tile] : search->start_row[tile];
+		num_goals++;
+	}
+
+	//The longest run of them that is already in order can stay, and everything else has to get out of its way
+	int* longest = search->line_longest;
+	int longest_overall = 0;
+
+	for(int i = 0; i < num_goals; i++){
+		longest[i] = 1;
+		for(int j = 0; j < i; j++){
+			if(goals[j] < goals[i] && longest[j] + 1 > longest[i]){
+				longest[i] = longest[j] + 1;
+			}
+		}
+
+		if(longest[i] > longest_overall){
+			longest_overall = longest[i];
+		}
+	}
+
+	return num_goals - longest_overall;
+}
+
+
+/**
+ * The backward direction's estimate of a state, from scratch
+ */
+static int start_cost(struct bidirectional_search* search, struct state* statePtr){
+	int N = search->N;
+	int cost = 0;
+
+	for(int i = 0; i < N * N; i++){
+		short tile = get_tile(statePtr, i, N);
+		if(tile != 0){
+			cost += start_distance(search, tile, i / N, i % N);
+		}
+	}
+
+	for(int line = 0; line < N; line++){
+		cost += 2 * (start_line_conflicts(search, statePtr, line, 1) + start_line_conflicts(search, statePtr, line, 0));
+	}
+
+	return cost;
+}
+
+
+/**
+ * Estimate the cost of a state in the given direction, and set its priority to match. The backward direction uses
+ * linear conflicts towards the start state instead of the goal, and works from its predecessor whenever it has one,
+ * since only one tile has moved. Backward states never use the forward heuristic, so they keep their whole
+ * backward estimate in base_heuristic_cost for the next update to work from.
+ *
+ * MM stops as soon as its bounds say that it can, so an estimate that is ever too high would hand back a longer path
+ * than it should. Like update_prediction_function, the backward direction only counts the tiles that actually have to
+ * leave each line, rather than every pair of tiles that are out of order
+ */
+static void estimate(struct bidirectional_search* search, struct state* statePtr, const int direction){
+	int N = search->N;
+
+	if(direction == FORWARD){
+		update_heuristic(statePtr, N, search->heuristic);
+		set_priority(statePtr);
+		return;
+	}
+
+	struct state* predecessor = statePtr->predecessor;
+
+	if(predecessor == NULL){
+		statePtr->heuristic_cost = start_cost(search, statePtr);
+	} else {
+		//The moved tile now sits where the predecessor's blank was, and it used to be where the blank now is
+		int new_row = predecessor->zero_row;
+		int new_column = predecessor->zero_column;
+		int old_row = statePtr->zero_row;
+		int old_column = statePtr->zero_column;
+		short tile = get_tile(statePtr, new_row * N + new_column, N);
+
+		int change = start_distance(search, tile, new_row, new_column) - start_distance(search, tile, old_row, old_column);
+
+		//A horizontal move leaves every row in the same order, and only changes the two columns that the tile moved
+		//between. A vertical move is the same with rows and columns swapped
+		int is_row = old_row == new_row ? 0 : 1;
+		int old_line = is_row == 1 ? old_row : old_column;
+		int new_line = is_row == 1 ? new_row : new_column;
+
+		change += 2 * (start_line_conflicts(search, statePtr, old_line, is_row) + start_line_conflicts(search, statePtr, new_line, is_row)
+					   - start_line_conflicts(search, predecessor, old_line, is_row) - start_line_conflicts(search, predecessor, new_line, is_row));
+
+		statePtr->heuristic_cost = predecessor->base_heuristic_cost + change;
+
+#ifdef HEURISTIC_CROSS_CHECK
+		//Recompute from scratch and make sure that we agree
+		if(statePtr->heuristic_cost != start_cost(search, statePtr)){
+			printf("ERROR: Incremental backward cost %d does not match the full backward cost %d\n",
+				   statePtr->heuristic_cost, start_cost(search, statePtr));
+			print_state(statePtr, N, 0);
+			abort();
+		}
+#endif
+	}
+
+	statePtr->base_heuristic_cost = statePtr->heuristic_cost;
+	set_priority(statePtr);
+}
+
+
+/**
+ * Generate every successor of statePtr in the given direction, merge them into that direction's fringe, and look
+ * each one up in the other direction to see if the two searches have met
+ * 0 = left move, 1 = right move, 2 = down move, 3 = up move
+ */
+static void expand_state(struct bidirectional_search* search, struct state* statePtr, const int direction){
+	int N = search->N;
+	int other = 1 - direction;
+
+	for(int move = 0; move < 4; move++){
+		//Skip the moves that would take the blank off of the board
+		if((move == 0 && statePtr->zero_column == 0) || (move == 1 && statePtr->zero_column == N - 1)
+		   || (move == 2 && statePtr->zero_row == N - 1) || (move == 3 && statePtr->zero_row == 0)){
+			continue;
+		}
+
+		//A pruned move, like undoing the last one, would only ever lead to a repeat, so don't make it at all
+		int move_state = next_move_state(search->machine, statePtr->move_state, move);
+		if(move_state == MOVE_PRUNED){
+			continue;
+		}
+
+		struct state* successor = arena_allocate_state(search->arena);
+		copy_state(statePtr, successor, N);
+		successor->move_state = move_state;
+
+		if(move == 0){
+			move_left(successor, N);
+		} else if(move == 1){
+			move_right(successor, N);
+		} else if(move == 2){
+			move_down(successor, N);
+		} else {
+			move_up(successor, N);
+		}
+
+		estimate(search, successor, direction);
+
+		//The usual repeat checks, only cheaper paths are let through
+		struct state* successors[4] = {successor, NULL, NULL, NULL};
+		check_repeating_closed(search->closed[direction], &(successors[0]), N);
+		check_repeating_fringe(search->fringes[direction], &(successors[0]), N);
+
+		if(successors[0] == NULL){
+			arena_release_state(search->arena, successor);
+			continue;
+		}
+
+		//If this was a cheaper path to a state in the fringe, the fringe copy takes it over
+		int inserted = merge_to_fringe(search->fringes[direction], successors, N);
+		struct state* kept = inserted == 1 ? successor : find_in_fringe(search->fringes[direction], successor, N);
+		search->generated += inserted;
+
+		//Has the other direction already been here?
+		struct state* meeting = find_in_fringe(search->fringes[other], kept, N);
+		if(meeting == NULL){
+			meeting = find_in_closed(search->closed[other], kept, N);
+		}
+
+		if(meeting != NULL && kept->current_travel + meeting->current_travel < search->best_cost){
+			search->best_cost = kept->current_travel + meeting->current_travel;
+			search->meeting[direction] = kept;
+			search->meeting[other] = meeting;
+		}
+
+		if(inserted == 0){
+			arena_release_state(search->arena, successor);
+		}
+	}
+}
+
+
+/**
+ * Splice the backward half of the path onto the forward half. The backward states are linked towards the goal,
+ * so their predecessors are turned around, and their costs are redone as if the forward direction had found them.
+ * Returns the goal end of the spliced path
+ */
+static struct state* splice_paths(struct bidirectional_search* search){
+	int N = search->N;
+	struct state* previous = search->meeting[FORWARD];
+	struct state* cursor = search->meeting[BACKWARD]->predecessor;
+	struct state* next;
+
+	//The backward meeting state is the same as the forward one, so we start with the one after it
+	while(cursor != NULL){
+		next = cursor->predecessor;
+
+		cursor->predecessor = previous;
+		cursor->current_travel = previous->current_travel + 1;
+		update_heuristic(cursor, N, search->heuristic);
+
+		previous = cursor;
+		cursor = next;
+	}
+
+	return previous;
+}
+
+
+/**
+ * Run MM from start and goal_state, expanding whichever direction has the smaller priority at the front of its
+ * fringe until the best meeting is proven optimal
+ */
+struct state* bidirectional_search(struct state_arena* arena, struct state* start, struct state* goal_state, const int N,
+								   int solver_mode, struct solver_options* options){
+	struct bidirectional_search search;
+
+	//If we're already there, there's nothing to search
+	if(states_same(start, goal_state, N)){
+		options->statistics.expanded = 0;
+		options->statistics.generated = 0;
+		return start;
+	}
+
+	search.arena = arena;
+	search.N = N;
+	search.heuristic = options->heuristic;
+	search.machine = move_pruning_machine(N, options->pruning);
+	search.best_cost = INT_MAX;
+	search.meeting[FORWARD] = NULL;
+	search.meeting[BACKWARD] = NULL;
+	search.expanded = 0;
+	search.generated = 0;
+
+	//Remember where every tile is in the start state
+	search.start_row = malloc(sizeof(int) * N * N);
+	search.start_column = malloc(sizeof(int) * N * N);
+	search.line_goals = malloc(sizeof(int) * N);
+	search.line_longest = malloc(sizeof(int) * N);
+	for(int i = 0; i < N * N; i++){
+		short tile = get_tile(start, i, N);
+		search.start_row[tile] = i / N;
+		search.start_column[tile] = i % N;
+	}
+
+	for(int direction = FORWARD; direction <= BACKWARD; direction++){
+		search.fringes[direction] = initialize_fringe(options->fringe);
+		search.closed[direction] = initialize_closed();
+	}
+
+	//The start state already has its costs, it only needs its priority
+	set_priority(start);
+	priority_queue_insert(search.fringes[FORWARD], start);
+
+	//The backward direction starts from its own copy of the goal
+	struct state* goal = arena_allocate_state(arena);
+	copy_state(goal_state, goal, N);
+	goal->current_travel = 0;
+	goal->predecessor = NULL;
+	goal->move_state = MOVE_PRUNING_START;
+	estimate(&search, goal, BACKWARD);
+	priority_queue_insert(search.fringes[BACKWARD], goal);
+
+	while(!fringe_empty(search.fringes[FORWARD]) && !fringe_empty(search.fringes[BACKWARD])){
+		int forward_priority = fringe_peek(search.fringes[FORWARD])->total_cost;
+		int backward_priority = fringe_peek(search.fringes[BACKWARD])->total_cost;
+		int smallest_priority = forward_priority <= backward_priority ? forward_priority : backward_priority;
+
+		//No meeting that we could still find can be cheaper than this one
+		if(search.best_cost <= smallest_priority){
+			break;
+		}
+
+		//Expand the more promising direction
+		int direction = forward_priority <= backward_priority ? FORWARD : BACKWARD;
+		struct state* curr_state = dequeue(search.fringes[direction]);
+		merge_to_closed(search.closed[direction], curr_state, N);
+		expand_state(&search, curr_state, direction);
+		search.expanded++;
+
+		//For very complex problems, print the iteration count to the console for a sanity check
+		if(solver_mode == 1 && search.expanded % 1000 == 0){
+			printf("Iteration: %6ld, %6ld total unique states generated\n", search.expanded, search.generated);
+		}
+	}
+
+	options->statistics.expanded = search.expanded;
+	options->statistics.generated = search.generated;
+
+	for(int direction = FORWARD; direction <= BACKWARD; direction++){
+		cleanup_fringe_closed(search.fringes[direction], search.closed[direction]);
+	}
+	free(search.start_row);
+	free(search.start_column);
+	free(search.line_goals);
+	free(search.line_longest);
+
+	//The directions never met, so there is no solution
+	if(search.meeting[FORWARD] == NULL){
+		return NULL;
+	}
+
+	return splice_paths(&search);
+}
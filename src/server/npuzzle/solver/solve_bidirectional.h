@@ -0,0 +1,52 @@
+/**
+ * Author: Jack Robbins
+ * This header file defines the bidirectional MM engine, which searches forwards from the start state and backwards
+ * from the goal state at the same time, and stops once the two searches have met at a proven optimal point. The
+ * functions are implemented in solve_bidirectional.c
+ */
+
+#ifndef SOLVE_BIDIRECTIONAL_H
+#define SOLVE_BIDIRECTIONAL_H
+
+//The two directions, used as indices into everything that each direction keeps
+#define FORWARD 0
+#define BACKWARD 1
+
+#include "solve.h"
+
+/**
+ * Everything that both directions of one search share
+ */
+struct bidirectional_search {
+	struct state_arena* arena;
+	int N;
+	//The heuristic that the forward direction uses towards the goal
+	heuristic_type heuristic;
+	//The moves that are never worth making, in either direction
+	const struct move_pruning_machine* machine;
+	//Where every tile is in the start state, which is the backward direction's goal
+	int* start_row;
+	int* start_column;
+	//Room for one row or column's worth of the backward direction's linear conflicts to be worked out in
+	int* line_goals;
+	int* line_longest;
+	//One fringe and closed set for each direction
+	struct fringe* fringes[2];
+	struct closed* closed[2];
+	//The cheapest path found so far, and the two states that it meets at
+	int best_cost;
+	struct state* meeting[2];
+	long expanded;
+	long generated;
+};
+
+
+/**
+ * Run MM from start, whose costs must already be filled in, and from goal_state at the same time. Every state
+ * comes from the arena, and the one that is returned is linked back to start through predecessor, with both
+ * halves of the path already spliced together. Returns NULL if there is no solution
+ */
+struct state* bidirectional_search(struct state_arena* arena, struct state* start, struct state* goal_state, const int N,
+								   int solver_mode, struct solver_options* options);
+
+#endif /* SOLVE_BIDIRECTIONAL_H */
@@ -0,0 +1,512 @@
+/**
+ * Author: Jack Robbins
+ * This file implements HDA*, a hash distributed parallel A* search. The states are split between the workers by
+ * their hash, so that every state has exactly one owner, and only its owner ever looks for it in a fringe or closed
+ * set. A worker that generates a state that belongs to someone else sends it over instead, in batches, through
+ * lock free inboxes.
+ *
+ * Since the workers expand states out of the global order of total_cost, a state may be expanded before its
+ * cheapest path is known, so cheaper repeats of closed states are reopened. The first goal found is therefore
+ * only an incumbent, and the search goes on until no state that could beat it is left anywhere. That happens
+ * when every worker is idle and no state is in flight between them.
+ *
+ * Left to themselves, the workers would each run through their own share of the states at their own pace, and one
+ * that got ahead would expand states well past the optimal cost before there is any incumbent to cut them off. So
+ * every worker publishes the total_cost at the front of its fringe, and the smallest of those is the floor of the
+ * whole search. A worker never expands anything above the floor. It sends off what it has and waits for the floor to
+ * catch up instead, so the workers go through the total_costs together, the way that A* does on its own
+ */
+
+//For INT_MAX
+#include <limits.h>
+//For the number of processors
+#include <unistd.h>
+//For sched_yield
+#include <sched.h>
+#include "solve_hda.h"
+
+//How many HDA* workers are running right now, across every search in the process
+static atomic_int workers_running = 0;
+
+
+/**
+ * Reserve up to wanted workers for one search, out of one for every processor across the whole process, so that a
+ * server solving several puzzles at once doesn't start more workers than it can run. A search always gets at least
+ * the one worker that the thread calling it runs itself. Every worker reserved has to be given back with
+ * release_workers
+ */
+static int reserve_workers(const int wanted){
+	long processors = sysconf(_SC_NPROCESSORS_ONLN);
+	int limit = processors < 1 ? 1 : (processors > HDA_MAX_WORKERS ? HDA_MAX_WORKERS : processors);
+	int running = atomic_load(&workers_running);
+	int granted;
+
+	do {
+		granted = limit - running < wanted ? limit - running : wanted;
+		if(granted < 1){
+			granted = 1;
+		}
+	} while(!atomic_compare_exchange_weak(&workers_running, &running, running + granted));
+
+	return granted;
+}
+
+
+/**
+ * Give back the workers that a search reserved
+ */
+static void release_workers(const int granted){
+	atomic_fetch_sub(&workers_running, granted);
+}
+
+
+/**
+ * Find the worker that owns a state. The low bits of the hash pick the slots in the fringe and closed tables,
+ * so we use the high bits here to keep the two independent
+ */
+static int owner_of(struct hda_search* search, struct state* statePtr){
+	return (statePtr->hash >> 32) % search->num_workers;
+}
+
+
+/**
+ * Push every state in a worker's batch for destination onto destination's inbox with a single compare and swap
+ */
+static void send_batch(struct hda_worker* worker, const int destination){
+	//Nothing to send
+	if(worker->batch_size[destination] == 0){
+		return;
+	}
+
+	struct hda_search* search = worker->search;
+	struct hda_worker* receiver = &(search->workers[destination]);
+
+	//These are in flight until the receiver acknowledges them, which must be counted before they can be seen
+	atomic_fetch_add(&(search->in_flight), worker->batch_size[destination]);
+
+	//The floor has to count them as well, or we'd think that the search had moved on without them. The receiver puts
+	//its own frontier back once it has taken them in, and lowering it first means that it can't do that too early
+	int frontier = atomic_load(&(receiver->frontier));
+	while(worker->batch_min[destination] < frontier
+		  && !atomic_compare_exchange_weak(&(receiver->frontier), &frontier, worker->batch_min[destination])){
+	}
+
+	//Link the whole batch in front of whatever is already in the inbox
+	struct state* head = atomic_load(&(receiver->inbox));
+	do {
+		worker->batch_tail[destination]->next = head;
+	} while(!atomic_compare_exchange_weak(&(receiver->inbox), &head, worker->batch_head[destination]));
+
+	//The receiver checks its inbox after saying that it's going to sleep, and we check whether it's asleep after
+	//filling its inbox, so at least one of us sees the other
+	if(atomic_load(&(receiver->sleeping)) == 1){
+		pthread_mutex_lock(&(receiver->sleep_lock));
+		pthread_cond_signal(&(receiver->wake_up));
+		pthread_mutex_unlock(&(receiver->sleep_lock));
+	}
+
+	worker->batch_head[destination] = NULL;
+	worker->batch_tail[destination] = NULL;
+	worker->batch_size[destination] = 0;
+	worker->batch_min[destination] = INT_MAX;
+}
+
+
+/**
+ * Send off every partly full batch that a worker has
+ */
+static void send_all_batches(struct hda_worker* worker){
+	for(int i = 0; i < worker->search->num_workers; i++){
+		send_batch(worker, i);
+	}
+}
+
+
+/**
+ * Put a state that this worker owns into its fringe, unless it is no better than a copy that we already have.
+ * Returns 1 if the state itself went into the fringe, 0 if it isn't needed anymore
+ */
+static int accept_state(struct hda_worker* worker, struct state* statePtr){
+	struct hda_search* search = worker->search;
+
+	//Nothing that can't beat the incumbent is worth keeping
+	if(statePtr->total_cost >= atomic_load(&(search->incumbent_cost))){
+		return 0;
+	}
+
+	//The same checks that generate_move makes, only against this worker's own sets
+	check_repeating_closed(worker->closed, &statePtr, search->N);
+	check_repeating_fringe(worker->fringe, &statePtr, search->N);
+
+	if(statePtr == NULL){
+		return 0;
+	}
+
+	//merge_to_fringe takes care of the decrease-key if this is a cheaper repeat of a state in the fringe
+	struct state* successors[4] = {statePtr, NULL, NULL, NULL};
+	int inserted = merge_to_fringe(worker->fringe, successors, search->N);
+	worker->generated += inserted;
+
+	return inserted;
+}
+
+
+/**
+ * Take everything out of a worker's inbox at once and accept it
+ */
+static void receive_states(struct hda_worker* worker){
+	struct state* cursor = atomic_exchange(&(worker->inbox), NULL);
+	struct state* next;
+
+	while(cursor != NULL){
+		next = cursor->next;
+		cursor->next = NULL;
+
+		accept_state(worker, cursor);
+		//This one isn't acknowledged until we go idle, so the termination check can't miss what it leads to
+		(worker->unacknowledged)++;
+
+		cursor = next;
+	}
+}
+
+
+/**
+ * Generate every successor of statePtr, keeping the ones that we own and sending the rest to their owners
+ * 0 = left move, 1 = right move, 2 = down move, 3 = up move
+ */
+static void expand_state(struct hda_worker* worker, struct state* statePtr){
+	struct hda_search* search = worker->search;
+	int N = search->N;
+
+	for(int move = 0; move < 4; move++){
+		//Skip the moves that would take the blank off of the board
+		if((move == 0 && statePtr->zero_column == 0) || (move == 1 && statePtr->zero_column == N - 1)
+		   || (move == 2 && statePtr->zero_row == N - 1) || (move == 3 && statePtr->zero_row == 0)){
+			continue;
+		}
+
+		//A pruned move, like undoing the last one, would only ever lead to a repeat, so don't make it at all
+		int move_state = next_move_state(search->machine, statePtr->move_state, move);
+		if(move_state == MOVE_PRUNED){
+			continue;
+		}
+
+		struct state* successor = arena_allocate_state(worker->arena);
+		copy_state(statePtr, successor, N);
+		successor->move_state = move_state;
+
+		if(move == 0){
+			move_left(successor, N);
+		} else if(move == 1){
+			move_right(successor, N);
+		} else if(move == 2){
+			move_down(successor, N);
+		} else {
+			move_up(successor, N);
+		}
+
+		update_heuristic(successor, N, search->heuristic);
+
+		int owner = owner_of(search, successor);
+
+		//Our own states go straight in, and the ones that we don't need can be reused. The ones that we received
+		//came out of someone else's arena, so those just stay put until the search is over
+		if(owner == worker->id){
+			if(accept_state(worker, successor) == 0){
+				arena_release_state(worker->arena, successor);
+			}
+			continue;
+		}
+
+		//Everyone else's go into their batch
+		successor->next = NULL;
+		if(worker->batch_head[owner] == NULL){
+			worker->batch_head[owner] = successor;
+		} else {
+			worker->batch_tail[owner]->next = successor;
+		}
+		worker->batch_tail[owner] = successor;
+		(worker->batch_size[owner])++;
+		if(successor->total_cost < worker->batch_min[owner]){
+			worker->batch_min[owner] = successor->total_cost;
+		}
+
+		if(worker->batch_size[owner] == HDA_BATCH_SIZE){
+			send_batch(worker, owner);
+		}
+	}
+}
+
+
+/**
+ * Tell the other workers the cheapest total_cost that this worker could expand next
+ */
+static void publish_frontier(struct hda_worker* worker){
+	int frontier = fringe_empty(worker->fringe) ? INT_MAX : fringe_peek(worker->fringe)->total_cost;
+
+	//Only write when it changes, so that the others don't keep losing the cache line
+	if(atomic_load_explicit(&(worker->frontier), memory_order_relaxed) != frontier){
+		atomic_store(&(worker->frontier), frontier);
+	}
+}
+
+
+/**
+ * The floor of the whole search, the smallest total_cost at the front of any worker's fringe. States that are still
+ * in flight aren't counted, so this can be a little high for a moment, which only ever lets a worker run ahead
+ */
+static int search_floor(struct hda_search* search){
+	int floor = INT_MAX;
+
+	for(int i = 0; i < search->num_workers; i++){
+		int frontier = atomic_load(&(search->workers[i].frontier));
+		if(frontier < floor){
+			floor = frontier;
+		}
+	}
+
+	return floor;
+}
+
+
+/**
+ * Record a goal state if it is cheaper than the incumbent
+ */
+static void offer_incumbent(struct hda_search* search, struct state* statePtr){
+	pthread_mutex_lock(&(search->incumbent_mutex));
+
+	if(statePtr->current_travel < atomic_load(&(search->incumbent_cost))){
+		search->incumbent = statePtr;
+		atomic_store(&(search->incumbent_cost), statePtr->current_travel);
+	}
+
+	pthread_mutex_unlock(&(search->incumbent_mutex));
+}
+
+
+/**
+ * End the search, and wake up every worker that is asleep so that it can see that it's over
+ */
+static void finish_search(struct hda_search* search){
+	atomic_store(&(search->done), 1);
+
+	//Every sleeper checks done while holding its lock, so it's either already seen it or it's waiting by now
+	for(int i = 0; i < search->num_workers; i++){
+		pthread_mutex_lock(&(search->workers[i].sleep_lock));
+		pthread_cond_signal(&(search->workers[i].wake_up));
+		pthread_mutex_unlock(&(search->workers[i].sleep_lock));
+	}
+}
+
+
+/**
+ * Wait for more work after running out. Returns 1 if more work has arrived, or 0 if the whole search is done.
+ *
+ * A worker only stops being idle when something is in its inbox, and it doesn't acknowledge what it received until
+ * it is idle again, after it has sent everything that those states led to. So if every worker is idle and then
+ * nothing is in flight, no worker can have woken up in between, and there is nothing left to do. Nothing is ever
+ * acknowledged by a worker that is already idle, so the last worker to go idle is always the one that finds this
+ * out, and the others can sleep until something arrives instead of checking over and over
+ */
+static int wait_for_work(struct hda_worker* worker){
+	struct hda_search* search = worker->search;
+
+	//Nothing here to hold the floor down anymore
+	publish_frontier(worker);
+
+	//Send everything that we have, and only then acknowledge everything that we've received
+	send_all_batches(worker);
+	atomic_fetch_sub(&(search->in_flight), worker->unacknowledged);
+	worker->unacknowledged = 0;
+
+	atomic_fetch_add(&(search->idle), 1);
+
+	while(1){
+		if(atomic_load(&(search->done)) == 1){
+			return 0;
+		}
+
+		//Something has arrived, so we're busy again
+		if(atomic_load(&(worker->inbox)) != NULL){
+			atomic_fetch_sub(&(search->idle), 1);
+			return 1;
+		}
+
+		//The order of these two loads matters, idle must be read first
+		if(atomic_load(&(search->idle)) == search->num_workers && atomic_load(&(search->in_flight)) == 0){
+			finish_search(search);
+			return 0;
+		}
+
+		//Sleep until a batch arrives or the search is over, checking for both once more after saying so
+		pthread_mutex_lock(&(worker->sleep_lock));
+		atomic_store(&(worker->sleeping), 1);
+
+		if(atomic_load(&(worker->inbox)) == NULL && atomic_load(&(search->done)) == 0){
+			pthread_cond_wait(&(worker->wake_up), &(worker->sleep_lock));
+		}
+
+		atomic_store(&(worker->sleeping), 0);
+		pthread_mutex_unlock(&(worker->sleep_lock));
+	}
+}
+
+
+/**
+ * The main loop of every worker
+ */
+static void* hda_worker_main(void* worker_ptr){
+	struct hda_worker* worker = (struct hda_worker*)worker_ptr;
+	struct hda_search* search = worker->search;
+	int since_sent = 0;
+	//The last floor that we saw. It's only looked at again once we're past it, or when we send our batches, so it
+	//starts out where we're sure to be past it
+	int floor = 0;
+
+	while(1){
+		receive_states(worker);
+
+		//Out of work, so wait for more or for the end of the search
+		if(fringe_empty(worker->fringe)){
+			if(wait_for_work(worker) == 0){
+				break;
+			}
+			continue;
+		}
+
+		publish_frontier(worker);
+
+		//We may be ahead of the rest of the search. Whatever the others need next may be in our batches, so send those
+		//off before looking, and if we are ahead, let them catch up. The worker that holds the floor is never ahead of
+		//it, so someone is always making progress
+		if(fringe_peek(worker->fringe)->total_cost > floor){
+			send_all_batches(worker);
+			since_sent = 0;
+			floor = search_floor(search);
+
+			if(fringe_peek(worker->fringe)->total_cost > floor){
+				sched_yield();
+				continue;
+			}
+		}
+
+		struct state* curr_state = dequeue(worker->fringe);
+
+		//The fringe is in order, so if this can't beat the incumbent then nothing left in it can
+		if(curr_state->total_cost >= atomic_load(&(search->incumbent_cost))){
+			continue;
+		}
+
+		//A goal isn't expanded, it just becomes the incumbent if it's the best so far
+		if(states_same(curr_state, search->goal_state, search->N)){
+			offer_incumbent(search, curr_state);
+			continue;
+		}
+
+		expand_state(worker, curr_state);
+		merge_to_closed(worker->closed, curr_state, search->N);
+		(worker->expanded)++;
+
+		//Don't let partly full batches wait around for too long
+		since_sent++;
+		if(since_sent == HDA_FLUSH_INTERVAL){
+			send_all_batches(worker);
+			since_sent = 0;
+			//States that we sent may be cheaper than the floor that we saw, so look at it again
+			floor = search_floor(search);
+		}
+	}
+
+	return NULL;
+}
+
+
+/**
+ * Run HDA* from start. The start state is sent to its owner like any other, then every worker runs until the
+ * whole search is done
+ */
+struct state* hda_search(struct state_arena* arena, struct state* start, struct state* goal_state, const int N,
+						 int solver_mode, struct solver_options* options){
+	struct hda_search search;
+
+	//Use every processor unless we were told otherwise, as long as the other searches aren't using them already
+	int num_workers = reserve_workers(options->threads > 0 ? options->threads : HDA_MAX_WORKERS);
+
+	if(solver_mode == 1){
+		printf("Running HDA* with %d workers\n", num_workers);
+	}
+
+	search.workers = aligned_alloc(_Alignof(struct hda_worker), sizeof(struct hda_worker) * num_workers);
+	search.num_workers = num_workers;
+	search.goal_state = goal_state;
+	search.N = N;
+	search.heuristic = options->heuristic;
+	search.machine = move_pruning_machine(N, options->pruning);
+	atomic_init(&(search.in_flight), 0);
+	atomic_init(&(search.idle), 0);
+	atomic_init(&(search.done), 0);
+	atomic_init(&(search.incumbent_cost), INT_MAX);
+	search.incumbent = NULL;
+	pthread_mutex_init(&(search.incumbent_mutex), NULL);
+
+	for(int i = 0; i < num_workers; i++){
+		struct hda_worker* worker = &(search.workers[i]);
+
+		atomic_init(&(worker->inbox), NULL);
+		atomic_init(&(worker->sleeping), 0);
+		atomic_init(&(worker->frontier), INT_MAX);
+		pthread_mutex_init(&(worker->sleep_lock), NULL);
+		pthread_cond_init(&(worker->wake_up), NULL);
+		worker->id = i;
+		worker->search = &search;
+		worker->arena = initialize_arena(N);
+		worker->fringe = initialize_fringe(options->fringe);
+		worker->closed = initialize_closed();
+		memset(worker->batch_head, 0, sizeof(worker->batch_head));
+		memset(worker->batch_tail, 0, sizeof(worker->batch_tail));
+		memset(worker->batch_size, 0, sizeof(worker->batch_size));
+		for(int j = 0; j < HDA_MAX_WORKERS; j++){
+			worker->batch_min[j] = INT_MAX;
+		}
+		worker->unacknowledged = 0;
+		worker->expanded = 0;
+		worker->generated = 0;
+	}
+
+	//Send the start state to its owner before anyone starts, so that it's counted as in flight
+	start->next = NULL;
+	atomic_store(&(search.in_flight), 1);
+	atomic_store(&(search.workers[owner_of(&search, start)].inbox), start);
+
+	//This thread is the first worker, so a search that only gets one worker doesn't start any threads at all
+	for(int i = 1; i < num_workers; i++){
+		pthread_create(&(search.workers[i].thread), NULL, hda_worker_main, &(search.workers[i]));
+	}
+	hda_worker_main(&(search.workers[0]));
+
+	options->statistics.expanded = 0;
+	options->statistics.generated = 0;
+
+	for(int i = 0; i < num_workers; i++){
+		struct hda_worker* worker = &(search.workers[i]);
+		if(i > 0){
+			pthread_join(worker->thread, NULL);
+		}
+
+		options->statistics.expanded += worker->expanded;
+		options->statistics.generated += worker->generated;
+
+		//The states may be on the solution path, so they live on in the solve's arena
+		cleanup_fringe_closed(worker->fringe, worker->closed);
+		arena_adopt(arena, worker->arena);
+		pthread_mutex_destroy(&(worker->sleep_lock));
+		pthread_cond_destroy(&(worker->wake_up));
+	}
+
+	pthread_mutex_destroy(&(search.incumbent_mutex));
+	free(search.workers);
+	release_workers(num_workers);
+
+	return search.incumbent;
+}
@@ -0,0 +1,92 @@
+/**
+ * Author: Jack Robbins
+ * This header file defines the HDA* engine, a hash distributed parallel A* that spreads a single solve across
+ * every core that no other solve is using. The functions are implemented in solve_hda.c
+ */
+
+#ifndef SOLVE_HDA_H
+#define SOLVE_HDA_H
+
+//The most workers that one search can have. Every search in the process shares one worker for each processor, so a
+//search gets fewer than it asks for while others are running
+#define HDA_MAX_WORKERS 64
+//How many states are sent to another worker at once
+#define HDA_BATCH_SIZE 32
+//How many expansions a worker makes before it sends off its partly full batches anyways
+#define HDA_FLUSH_INTERVAL 64
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include "solve.h"
+
+struct hda_search;
+
+/**
+ * Every worker owns the states whose hash maps to it, and keeps them in its own fringe and closed set. Any state
+ * that it generates for another worker is collected into a batch for that worker, and the batch is pushed onto the
+ * other worker's inbox all at once. The inbox is a lock free stack of states, linked together through next
+ */
+struct hda_worker {
+	//The lock free inbox that the other workers push batches onto
+	_Atomic(struct state*) inbox;
+	//Set while this worker is asleep, or about to be, waiting for something to arrive in its inbox
+	atomic_int sleeping;
+	//The total_cost at the front of this worker's fringe, or INT_MAX if it's empty. The smallest of these across every
+	//worker is the floor that no worker expands above
+	atomic_int frontier;
+	//What an idle worker sleeps on, and what it's woken up with when a batch arrives or the search is over
+	pthread_mutex_t sleep_lock;
+	pthread_cond_t wake_up;
+	int id;
+	struct hda_search* search;
+	pthread_t thread;
+	//Every state that this worker generates comes from its own arena, so the arenas need no lock
+	struct state_arena* arena;
+	struct fringe* fringe;
+	struct closed* closed;
+	//The batch being collected for every other worker, as a linked list with its tail and length
+	struct state* batch_head[HDA_MAX_WORKERS];
+	struct state* batch_tail[HDA_MAX_WORKERS];
+	int batch_size[HDA_MAX_WORKERS];
+	//The cheapest total_cost in every batch, which the receiver's frontier is lowered to when it's sent
+	int batch_min[HDA_MAX_WORKERS];
+	//States that we've received, but not yet told the termination check about
+	long unacknowledged;
+	long expanded;
+	long generated;
+} __attribute__((aligned(64)));
+
+
+/**
+ * Everything that the workers of one search share
+ */
+struct hda_search {
+	struct hda_worker* workers;
+	int num_workers;
+	struct state* goal_state;
+	int N;
+	heuristic_type heuristic;
+	//The moves that are never worth making
+	const struct move_pruning_machine* machine;
+	//How many states have been sent but not yet acknowledged by the worker that received them
+	atomic_long in_flight;
+	//How many workers have run out of work
+	atomic_int idle;
+	//Set once every worker is idle and nothing is in flight
+	atomic_int done;
+	//The cheapest path to the goal found so far, nothing at least as expensive is worth expanding
+	atomic_int incumbent_cost;
+	struct state* incumbent;
+	pthread_mutex_t incumbent_mutex;
+};
+
+
+/**
+ * Run HDA* from start, whose costs must already be filled in, until goal_state is found. The states that the
+ * workers generate end up in arena, and the one that is returned is linked back to start through predecessor.
+ * Returns NULL if there is no solution
+ */
+struct state* hda_search(struct state_arena* arena, struct state* start, struct state* goal_state, const int N,
+						 int solver_mode, struct solver_options* options);
+
+#endif /* SOLVE_HDA_H */
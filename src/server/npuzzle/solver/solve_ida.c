@@ -0,0 +1,264 @@
+/**
+ * Author: Jack Robbins
+ * This file implements an IDA* search for the N puzzle. Instead of keeping every state that it has seen in a
+ * fringe and closed set, IDA* runs depth first searches with a growing bound on total_cost, so the only memory
+ * that it needs is the current path, the siblings along it, and a fixed size transposition table.
+ *
+ * Two things keep the depth first searches from redoing too much work. Children are never made by a move that
+ * the move pruning machine rules out, like undoing the move that made their parent, and the transposition table
+ * cuts off any state that was already reached at the same depth or shallower during the current iteration, as long
+ * as the machine pruned no more below it back then than it would now. The children of every state are also tried
+ * most promising first, so that the final iteration finds the goal as early as it can
+ */
+
+//For INT_MAX
+#include <limits.h>
+#include "solve_ida.h"
+
+/**
+ * Everything that the depth first search needs, kept in one place so that it isn't passed around on every call
+ */
+struct ida_context {
+	struct state_arena* arena;
+	struct state* goal_state;
+	int N;
+	heuristic_type heuristic;
+	//The moves that are never worth making
+	const struct move_pruning_machine* machine;
+	//The bound on total_cost for this iteration, and the smallest total_cost that went over it
+	int threshold;
+	int next_threshold;
+	//Iterations are numbered from 1 so that an empty table entry never matches
+	int iteration;
+	struct transposition_entry* table;
+	//How many entries the table has, and the tiles of every entry when the states aren't packed
+	u_int64_t table_size;
+	short* table_tiles;
+	//4 reusable child states for every depth that we've reached so far
+	struct state** children;
+	int max_depth;
+	//The state that matched the goal, if we've found it
+	struct state* goal_node;
+	long expanded;
+	long generated;
+};
+
+
+/**
+ * Make sure that there are child states reserved for the given depth
+ */
+static void reserve_children(struct ida_context* context, const int depth){
+	//We already have them
+	if(depth < context->max_depth){
+		return;
+	}
+
+	//Double the depth that we have room for
+	int new_max_depth = context->max_depth * 2;
+	if(new_max_depth <= depth){
+		new_max_depth = depth + 1;
+	}
+
+	context->children = realloc(context->children, sizeof(struct state*) * 4 * new_max_depth);
+
+	//The states themselves come from the arena, so they stay where they are
+	for(int i = context->max_depth * 4; i < new_max_depth * 4; i++){
+		context->children[i] = arena_allocate_state(context->arena);
+	}
+
+	context->max_depth = new_max_depth;
+}
+
+
+/**
+ * Returns 1 if the entry at the given slot holds the same tiles as statePtr. Only the hash is compared before this,
+ * so a collision has to be caught here or a subtree that was never searched would be cut off
+ */
+static int entry_matches(struct ida_context* context, struct transposition_entry* entry, const u_int64_t slot,
+						 struct state* statePtr){
+	int N = context->N;
+
+	if(N > PACKED_MAX_N){
+		return memcmp(context->table_tiles + slot * N * N, statePtr->tiles, sizeof(short) * N * N) == 0;
+	}
+
+	return entry->packed == statePtr->packed && (N <= PACKED_SMALL_MAX_N || entry->packed_high == statePtr->packed_high);
+}
+
+
+/**
+ * Check the transposition table for statePtr. Returns 1 if it has already been reached at the same depth or
+ * shallower during this iteration with no more of its moves pruned, otherwise records it and returns 0
+ */
+static int transposition_cutoff(struct ida_context* context, struct state* statePtr){
+	int N = context->N;
+	u_int64_t slot = statePtr->hash & (context->table_size - 1);
+	struct transposition_entry* entry = &(context->table[slot]);
+
+	//Its whole subtree has already been searched with at least as much of the bound left over. If the machine was
+	//in a state that pruned more back then, some of what we'd search now was skipped, so it has to be searched again
+	if(entry->iteration == context->iteration && entry->hash == statePtr->hash
+	   && entry->current_travel <= statePtr->current_travel
+	   && move_state_covers(context->machine, entry->move_state, statePtr->move_state) == 1
+	   && entry_matches(context, entry, slot, statePtr) == 1){
+		return 1;
+	}
+
+	//Always replace, the most recent states are the ones most likely to be seen again
+	entry->hash = statePtr->hash;
+	entry->current_travel = statePtr->current_travel;
+	entry->iteration = context->iteration;
+	entry->move_state = statePtr->move_state;
+
+	if(N > PACKED_MAX_N){
+		memcpy(context->table_tiles + slot * N * N, statePtr->tiles, sizeof(short) * N * N);
+	} else {
+		entry->packed = statePtr->packed;
+		entry->packed_high = N > PACKED_SMALL_MAX_N ? statePtr->packed_high : 0;
+	}
+
+	return 0;
+}
+
+
+/**
+ * Search below statePtr for the goal. Returns 1 if it was found
+ * 0 = left move, 1 = right move, 2 = down move, 3 = up move
+ */
+static int depth_first_search(struct ida_context* context, struct state* statePtr, const int depth){
+	int N = context->N;
+
+	//Too expensive for this iteration, but it may be the cheapest that went over
+	if(statePtr->total_cost > context->threshold){
+		if(statePtr->total_cost < context->next_threshold){
+			context->next_threshold = statePtr->total_cost;
+		}
+		return 0;
+	}
+
+	//Both heuristics are only 0 at the goal, so we only need to compare the states then
+	if(statePtr->heuristic_cost == 0 && states_same(statePtr, context->goal_state, N)){
+		context->goal_node = statePtr;
+		return 1;
+	}
+
+	if(transposition_cutoff(context, statePtr) == 1){
+		return 0;
+	}
+
+	context->expanded++;
+
+	reserve_children(context, depth);
+	struct state** children = &(context->children[depth * 4]);
+	//The children that we'll actually search
+	struct state* ordered[4];
+	int num_children = 0;
+
+	for(int move = 0; move < 4; move++){
+		//A pruned move, like undoing the last one, can never be part of a shortest path
+		int move_state = next_move_state(context->machine, statePtr->move_state, move);
+		if(move_state == MOVE_PRUNED){
+			continue;
+		}
+
+		//Skip the moves that would take the blank off of the board
+		if((move == 0 && statePtr->zero_column == 0) || (move == 1 && statePtr->zero_column == N - 1)
+		   || (move == 2 && statePtr->zero_row == N - 1) || (move == 3 && statePtr->zero_row == 0)){
+			continue;
+		}
+
+		struct state* child = children[move];
+		copy_state(statePtr, child, N);
+
+		if(move == 0){
+			move_left(child, N);
+		} else if(move == 1){
+			move_right(child, N);
+		} else if(move == 2){
+			move_down(child, N);
+		} else {
+			move_up(child, N);
+		}
+
+		child->move_state = move_state;
+		update_heuristic(child, N, context->heuristic);
+		context->generated++;
+
+		//Insertion sort on the heuristic, every child has the same current_travel
+		int slot = num_children;
+		while(slot > 0 && ordered[slot - 1]->heuristic_cost > child->heuristic_cost){
+			ordered[slot] = ordered[slot - 1];
+			slot--;
+		}
+		ordered[slot] = child;
+		num_children++;
+	}
+
+	//Try the most promising children first
+	for(int i = 0; i < num_children; i++){
+		if(depth_first_search(context, ordered[i], depth + 1) == 1){
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+
+/**
+ * Run IDA* from start. Each iteration is a depth first search bounded by threshold, and the next threshold is
+ * the smallest total_cost that went over the last one
+ */
+struct state* ida_search(struct state_arena* arena, struct state* start, struct state* goal_state, const int N,
+						 int solver_mode, struct solver_options* options){
+	struct ida_context context;
+
+	context.arena = arena;
+	context.goal_state = goal_state;
+	context.N = N;
+	context.heuristic = options->heuristic;
+	context.machine = move_pruning_machine(N, options->pruning);
+	context.threshold = start->total_cost;
+	context.iteration = 0;
+	//The transposition table is the only thing whose size doesn't depend on the depth. States that aren't packed need
+	//room for their tiles as well, so they get a smaller one
+	context.table_size = N > PACKED_MAX_N ? TRANSPOSITION_TILE_TABLE_SIZE : TRANSPOSITION_TABLE_SIZE;
+	context.table = calloc(context.table_size, sizeof(struct transposition_entry));
+	context.table_tiles = N > PACKED_MAX_N ? malloc(sizeof(short) * N * N * context.table_size) : NULL;
+	context.children = NULL;
+	context.max_depth = 0;
+	context.goal_node = NULL;
+	context.expanded = 0;
+	context.generated = 0;
+
+	while(context.goal_node == NULL){
+		context.iteration++;
+		context.next_threshold = INT_MAX;
+
+		//For very complex problems, print every threshold to the console for a sanity check
+		if(solver_mode == 1){
+			printf("Iteration: %3d, threshold: %4d, %ld states expanded so far\n", context.iteration, context.threshold, context.expanded);
+		}
+
+		if(depth_first_search(&context, start, 0) == 1){
+			break;
+		}
+
+		//Nothing went over the bound, so there's nowhere left to look
+		if(context.next_threshold == INT_MAX){
+			break;
+		}
+
+		context.threshold = context.next_threshold;
+	}
+
+	options->statistics.expanded = context.expanded;
+	options->statistics.generated = context.generated;
+
+	//The states themselves are all in the arena, and are released along with it
+	free(context.children);
+	free(context.table);
+	free(context.table_tiles);
+
+	return context.goal_node;
+}
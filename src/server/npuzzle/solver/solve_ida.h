@@ -0,0 +1,41 @@
+/**
+ * Author: Jack Robbins
+ * This header file defines the IDA* engine, which the solver can use instead of A* when memory
+ * matters more than anything else. The functions are implemented in solve_ida.c
+ */
+
+#ifndef SOLVE_IDA_H
+#define SOLVE_IDA_H
+
+//The number of entries in the transposition table, this must always be a power of 2
+#define TRANSPOSITION_TABLE_SIZE (1 << 20)
+//The number of entries for puzzles bigger than PACKED_MAX_N, which keep a copy of their tiles for every entry
+#define TRANSPOSITION_TILE_TABLE_SIZE (1 << 16)
+
+#include "solve.h"
+
+/**
+ * One entry in the transposition table. It remembers the shallowest depth that a state has been reached at
+ * during the current iteration, so that reaching it again at the same depth or deeper can be cut off
+ */
+struct transposition_entry {
+	u_int64_t hash;
+	//The packed tiles of the state, so that a collision on the hash is never taken for a match. Puzzles bigger than
+	//PACKED_MAX_N keep their tiles in a separate array instead
+	u_int64_t packed, packed_high;
+	int current_travel;
+	int iteration;
+	//Where the move pruning machine was, since that decides how much of the subtree was searched
+	u_int16_t move_state;
+};
+
+
+/**
+ * Run IDA* from start, whose costs must already be filled in, until goal_state is found. Every state comes
+ * from the arena, and the one that is returned is linked back to start through predecessor. Returns NULL
+ * if there is no solution
+ */
+struct state* ida_search(struct state_arena* arena, struct state* start, struct state* goal_state, const int N,
+						 int solver_mode, struct solver_options* options);
+
+#endif /* SOLVE_IDA_H */
@@ -13,78 +13,69 @@
 //For multi-threading functionality
 #include <pthread.h>
 #include "solve.h"
+#include "expansion_pool.h"
+#include "solve_ida.h"
+#include "solve_hda.h"
+#include "solve_bidirectional.h"
+#include "solve_anytime.h"
+#include "solve_reduction.h"
+#include "solve_partial_expansion.h"
+#include "solve_table.h"
+//To find out if the pattern database is there to use
+#include "../heuristic/pattern_database.h"
+//And the same for walking distance
+#include "../heuristic/walking_distance.h"
 
 /**
- * This worker thread function generates and checks the validity of a successor that is made by 
- * moving up, down, left or right based on the option given. It will also update the prediction function
- * of the successor if the successor is valid
+ * This function generates and checks the validity of a successor that is made by moving up, down, left
+ * or right based on the option given. It will also update the prediction function of the successor if
+ * the successor is valid. It is run by the expansion pool, by a dedicated thread, or inline
  */
-static void* generator_worker(void* thread_params){
-	//Initialize a state pointer to be null by default
-	struct state* moved = NULL;	
+static void generate_move(void* thread_params){
 	//Make an appropriate cast to the parameter input struct
 	struct thread_params* parameters = (struct thread_params*)thread_params;
 	//Grab the option for convenience
 	int option = parameters->option;
 	int N = parameters->N;
+	//generate_successors has already reserved the state from the arena, but only if the move is possible
+	struct state* moved = parameters->successors[option];
 
-	//Perform a left move if option is 0 and if possible
-	if(option == 0 && parameters->predecessor->zero_column > 0){
-		//Create the new state
-		moved = (struct state*)malloc(sizeof(struct state));
-		//Dynamically allocate the space needed in the state
-		initialize_state(moved, N);
-		//Perform a deep copy from predecessor to successor
-		copy_state(parameters->predecessor, moved, N);
-		//Use helper function to move left
-		move_left(moved, N);
+	//If the move isn't possible, there's no work to do
+	if(moved == NULL){
+		return;
+	}
 
-	//Perform a right move if option is 1 and if possible
-	} else if(option == 1 && parameters->predecessor->zero_column < N-1){
-		//Create the new state
-		moved = (struct state*)malloc(sizeof(struct state));
-		//Dynamically allocate the space needed in the state
-		initialize_state(moved, N);
-		//Perform a deep copy from predecessor to successor
-		copy_state(parameters->predecessor, moved, N);
-		//Use helper function to move right 
-		move_right(moved, N);
+	//Perform a deep copy from predecessor to successor
+	copy_state(parameters->predecessor, moved, N);
 
-	//Perform a down move if option is 2 and if possible
-	} else if(option == 2 && parameters->predecessor->zero_row < N-1){
-		//Create the new state
-		moved = (struct state*)malloc(sizeof(struct state));
-		//Dynamically allocate the space needed in the state
-		initialize_state(moved, N);
-		//Perform a deep copy from predecessor to successor
-		copy_state(parameters->predecessor, moved, N);
-		//Use helper function to move down	
+	//Perform a left move if option is 0
+	if(option == 0){
+		move_left(moved, N);
+	//Perform a right move if option is 1
+	} else if(option == 1){
+		move_right(moved, N);
+	//Perform a down move if option is 2
+	} else if(option == 2){
 		move_down(moved, N);
-
-	//Perform an up move if option is 3 and if possible
-	} else if(option == 3 && parameters->predecessor->zero_row > 0){
-		//Create the new state
-		moved = (struct state*)malloc(sizeof(struct state));
-		//Dynamically allocate the space needed in the state
-		initialize_state(moved, N);
-		//Perform a deep copy from predecessor to successor
-		copy_state(parameters->predecessor, moved, N);
-		//Use helper function to move up	
+	//Perform an up move if option is 3
+	} else {
 		move_up(moved, N);
 	}
-	
-	//Whether it's null or not, place the pointer into moved
-	parameters->successors[option] = moved;
-
-	//Only perform the checks if moved is not null
-	if(moved != NULL){
-		//Now we must check for repeating
-		//Important -- we need to modify the state in successors, not the local copy "moved"
-		check_repeating_closed(parameters->closed, &(parameters->successors[option]), N);
-		check_repeating_fringe(parameters->fringe, &(parameters->successors[option]), N);
-		//Update prediction function
-		update_prediction_function(parameters->successors[option], N);
-	}
+
+	//Now we must check for repeating
+	//Important -- we need to modify the state in successors, not the local copy "moved"
+	check_repeating_closed(parameters->closed, &(parameters->successors[option]), N);
+	check_repeating_fringe(parameters->fringe, &(parameters->successors[option]), N);
+	//Update prediction function, with whichever heuristic the solver is using
+	update_heuristic(parameters->successors[option], N, parameters->heuristic);
+}
+
+
+/**
+ * The thread function for EXPANSION_THREAD_PER_MOVE, which simply wraps generate_move
+ */
+static void* generator_worker(void* thread_params){
+	generate_move(thread_params);
 
 	//Threadwork done, no return value will be used
 	pthread_exit(NULL);
@@ -92,40 +83,100 @@ static void* generator_worker(void* thread_params){
 
 
 /**
- * This multi-threaded version of successor generation and validation spawns an individual thread for
- * each of the 4 possible moves, potentially expediting the process of generating and checking successors
+ * Generate and validate the successors of predecessor, using whichever expansion mode the options ask for.
+ * Every state that is reserved from the arena is also saved in generated, so that the caller can give back
+ * the ones that end up being rejected
  */
-static void generate_successors(struct fringe* fringe, struct closed* closed, struct state* predecessor, struct state** successors, int N){
-	//We will create 4 threads, once for each successor potential successor
-	pthread_t thread_arr[4];
-	//We also need 4 thread_param structures 
-	struct thread_params* param_arr[4];
+static void generate_successors(struct fringe* fringe, struct closed* closed, struct state_arena* arena, struct state* predecessor,
+								struct state** successors, struct state** generated, int N, expansion_mode mode, heuristic_type heuristic,
+								const struct move_pruning_machine* machine){
+	//We need 4 thread_param structures, one for each potential successor
+	struct thread_params param_arr[4];
+	//The parameters for only the moves that are possible, for handing off to the pool
+	void* tasks[4];
+	int num_tasks = 0;
+
+	//Which moves are possible at all
+	//0 = left move, 1 = right move, 2 = down move, 3 = up move
+	int possible[4] = {predecessor->zero_column > 0, predecessor->zero_column < N-1, predecessor->zero_row < N-1, predecessor->zero_row > 0};
 
-	//Create all 4 threads
 	for(int i = 0; i < 4; i++){
-		//Reserve space and allocate appropriate values in each thread_param
-		param_arr[i] = (struct thread_params*)malloc(sizeof(struct thread_params));
-		param_arr[i]->predecessor = predecessor;
+		//A pruned move would only ever lead to a repeat that closed or fringe throws out, so don't make it at all
+		int move_state = next_move_state(machine, predecessor->move_state, i);
+
+		//Reserve a state for every move that is left. This is done here on the main thread, so the arena never needs a lock
+		if(possible[i] == 1 && move_state != MOVE_PRUNED){
+			generated[i] = arena_allocate_state(arena);
+			//copy_state leaves this alone, so it can be set before the move is made
+			generated[i]->move_state = move_state;
+		} else {
+			generated[i] = NULL;
+		}
+	}
+
+	for(int i = 0; i < 4; i++){
+		//The workers will null out any successor that turns out to be a repeat
+		successors[i] = generated[i];
+
+		//Allocate appropriate values in each thread_param
+		param_arr[i].predecessor = predecessor;
 		//The option will tell the thread function what move to make
-		param_arr[i]->option = i;
+		param_arr[i].option = i;
 		//Set the value of N
-		param_arr[i]->N = N;
+		param_arr[i].N = N;
 		//Save in successors for storage
-		param_arr[i]->successors = successors;
+		param_arr[i].successors = successors;
 		//Pass in refences to closed and fringe
-		param_arr[i]->fringe = fringe;
-		param_arr[i]->closed = closed;	
+		param_arr[i].fringe = fringe;
+		param_arr[i].closed = closed;	
+		//And the heuristic that the successors are estimated with
+		param_arr[i].heuristic = heuristic;
+
+		//Only the possible moves have any work to do
+		if(generated[i] != NULL){
+			tasks[num_tasks] = &param_arr[i];
+			num_tasks++;
+		}
+	}
+
+	//The original approach, spawn a new thread for each of the 4 moves and rejoin them all
+	if(mode == EXPANSION_THREAD_PER_MOVE){
+		pthread_t thread_arr[4];
 
-		//Spawn our worker threads, generator_worker is the thread funtion, and paramArr[i]
+		//Spawn our worker threads, generator_worker is the thread funtion, and param_arr[i]
 		//is the needed struct input
-		pthread_create(&thread_arr[i], NULL, generator_worker, param_arr[i]);
+		for(int i = 0; i < 4; i++){
+			pthread_create(&thread_arr[i], NULL, generator_worker, &param_arr[i]);
+		}
+
+		//rejoin all the threads
+		for(int i = 0; i < 4; i++){
+			pthread_join(thread_arr[i], NULL);
+		}
+
+		return;
 	}
 
-	//rejoin all the threads
+	//Hand the moves off to the pool. If that works, we're done
+	if(mode == EXPANSION_POOL && run_on_expansion_pool(generate_move, tasks, num_tasks) == 1){
+		return;
+	}
+
+	//Otherwise the pool is saturated or we were asked to work inline, so do the moves one at a time ourselves
+	for(int i = 0; i < num_tasks; i++){
+		generate_move(tasks[i]);
+	}
+}
+
+
+/**
+ * Give back to the arena every state that was generated but did not make it into the fringe
+ */
+static void release_rejected(struct state_arena* arena, struct state** generated, struct state** successors){
 	for(int i = 0; i < 4; i++){
-		pthread_join(thread_arr[i], NULL);
-		//Free the memory from the parameter structure
-		free(param_arr[i]);
+		if(generated[i] != NULL && successors[i] == NULL){
+			arena_release_state(arena, generated[i]);
+		}
 	}
 }
 
@@ -133,63 +184,117 @@ static void generate_successors(struct fringe* fringe, struct closed* closed, st
 /**
  * A simple helper function that will perform all of the printing when we are in debug mode in our solver
  */
-void print_solution_path(struct state* solution_path, const int N, int pathlen, int num_unique_configs, double time_spent_CPU){
+void print_solution_path(struct solution* solution, const int N, struct solver_statistics* statistics){
+	//The path length is how many moves it takes
+	int pathlen = solution->num_moves;
+
 	//Print out the solution path first	
 	printf("\nSolution found! Now displaying solution path\n");
 	//Display the path length for the user
 	printf("Path Length: %d\n\n", pathlen); 
 
-	//Print out the solution path in order
-	while(solution_path != NULL){
-		print_state(solution_path, N, 0);
-		solution_path = solution_path->next;
-	}	
+	//Print out the solution path in order, every state is made again from the moves as we go
+	struct solution_iterator iterator;
+	initialize_solution_iterator(&iterator, solution, N);
+	do {
+		print_state(&(iterator.current), N, 0);
+	} while(solution_iterator_next(&iterator, N));
+	cleanup_solution_iterator(&iterator);
 
 	//Print out all running statistics
 	printf("================ Program Running Statistics ===============\n\n");
-	//Print out the path length
-	printf("Optimal solution path length: %d\n", pathlen);
+	//Print out the path length, and how far from optimal it could be if we didn't prove it optimal
+	if(statistics->suboptimality_bound > 1.0){
+		printf("Solution path length: %d, at most %.2f times optimal\n", pathlen, statistics->suboptimality_bound);
+	} else {
+		printf("Optimal solution path length: %d\n", pathlen);
+	}
 	//Print out the number of unique configurations generated
-	printf("Unique configurations generated by solver: %d\n", num_unique_configs);
-	//Print out total memory consumption in Megabytes
-	printf("Memory consumed: %.2f MB\n", (sizeof(struct state) + N*N*sizeof(short)) * num_unique_configs / 1048576.0);
+	printf("Unique configurations generated by solver: %ld\n", statistics->generated);
+	//Print out total memory consumption in Megabytes, packed states have no tile array
+	printf("Memory consumed: %.2f MB\n", state_size(N) * statistics->generated / 1048576.0);
 	//Print out CPU time(NOT wall time) spent
-	printf("Total CPU time spent: %.7f seconds\n\n", time_spent_CPU);	
+	printf("Total CPU time spent: %.7f seconds\n", statistics->cpu_time);	
+	//Print out the wall time, and how many states we expanded per second of it
+	printf("Total wall time spent: %.7f seconds\n", statistics->wall_time);
+	printf("Expansions per second: %.0f\n\n", statistics->expanded / statistics->wall_time);
 	printf("===========================================================\n\n");
 }
 
 
 /**
- * Use an A* search algorithm to solve the 15-puzzle problem by implementing the A* main loop. If the solve function 
- * is successful, it will print the resulting solution path to the console as well.  
- * For mode: 0 equals web client solve, 1 equals debug(CLI) mode
+ * Get the solver options that are best suited for a puzzle of size N
  */
-struct state* solve(int N, struct state* start_state, struct state* goal_state, int solver_mode){
-	//If we are in debug mode, we will start off by printing to the console
-	if(solver_mode == 1){
-		printf("\nInitial State:\n");
-		print_state(start_state, N, 0);
-		printf("Goal state\n");
-		print_state(goal_state, N, 0);
-	} 
-	
+struct solver_options default_solver_options(const int N){
+	struct solver_options options;
+
+	//For the smaller puzzles, total_cost stays small enough that a bucket queue is the fastest fringe. For
+	//the larger ones the range of total_cost grows, so we fall back to the heap
+	options.fringe = N <= 5 ? FRINGE_BUCKET : FRINGE_HEAP;
+	//There are never more than 4 successors to make, which takes far less time than handing them off to another thread
+	//and waiting for them to come back, so they are made inline unless the pool is asked for
+	options.expansion = EXPANSION_INLINE;
+	//The pattern database is far better informed than linear conflicts, so use it whenever we can. Otherwise walking
+	//distance is the next best thing for 4x4. The 5x5 table is too big to stay in the processor's caches, and the
+	//misses cost more than the expansions that it saves, so 5x5 only uses it when asked to
+	if(N == PATTERN_DATABASE_N && pattern_database_loaded()){
+		options.heuristic = HEURISTIC_PATTERN_DATABASE;
+	} else if(N <= WALKING_DISTANCE_BUILD_MAX_N && walking_distance_loaded(N)){
+		options.heuristic = HEURISTIC_WALKING_DISTANCE;
+	} else {
+		options.heuristic = HEURISTIC_LINEAR_CONFLICT;
+	}
+	//An optimal solve of a 5x5 can take longer than anyone is willing to wait, so it gets the anytime engine, which has
+	//a solution within its time budget. From 6x6 up, even that is lucky to find one at all, so those are reduced, and
+	//every 3x3 is just looked up in the distance table. Everything else gets PEA*, which keeps about half as many
+	//states as A* does, and is as fast. That includes the 4x4 with the pattern database, where IDA* still expands
+	//about twice as many states and takes twice as long, so it's only run when a solve asks to bound its memory
+	if(N >= 6){
+		options.engine = SOLVER_ENGINE_REDUCTION;
+	} else if(N == DISTANCE_TABLE_N && distance_table_loaded()){
+		options.engine = SOLVER_ENGINE_TABLE;
+	} else if(N == 5){
+		options.engine = SOLVER_ENGINE_ANYTIME;
+	} else {
+		options.engine = SOLVER_ENGINE_PARTIAL_EXPANSION;
+	}
+	//Pruning every known duplicate sequence is sound, and it throws out far more than the inverse moves alone
+	options.pruning = MOVE_PRUNING_MACHINE;
+	//HDA* is only ever run when it's asked for, and then it uses every processor that it can get
+	options.threads = 0;
+	//Anytime search gets a budget that keeps a solve from holding onto its thread forever
+	options.time_budget = ANYTIME_DEFAULT_TIME_BUDGET;
+	//Nothing has run yet
+	memset(&(options.statistics), 0, sizeof(struct solver_statistics));
+
+	return options;
+}
+
 
+/**
+ * Run the A* main loop from start, whose costs must already be filled in, until goal_state is found. Every
+ * state comes from the arena, and the one that is returned is linked back to start through predecessor.
+ * Returns NULL if there is no solution
+ */
+static struct state* astar_search(struct state_arena* arena, struct state* start, struct state* goal_state, const int N,
+								  int solver_mode, struct solver_options* options){
 	//Create the fringe and closed structues
-	struct fringe* fringe = initialize_fringe();
+	struct fringe* fringe = initialize_fringe(options->fringe);
 	struct closed* closed = initialize_closed();
 
-	//We will keep track of the time taken to execute
-	clock_t begin_CPU = clock();
-
 	//We will keep track of the number of iterations as a sanity check for large problems
 	int iteration = 0;
 	//We will also keep track of the number of unique configurations
 	int num_unique_configs = 0;
 	//Define an array for holding successor states. We can generate at most 4 each time
 	struct state* successors[4];
+	//Along with every state that we reserved for them
+	struct state* generated[4];
+	//The moves that we never need to make
+	const struct move_pruning_machine* machine = move_pruning_machine(N, options->pruning);
 
-	//Put the start_state into fringe to begin the search
-	priority_queue_insert(fringe, start_state);
+	//Put the start state into fringe to begin the search
+	priority_queue_insert(fringe, start);
 
 	//Maintain a pointer for the current state in the search
 	struct state* curr_state;
@@ -200,46 +305,16 @@ struct state* solve(int N, struct state* start_state, struct state* goal_state,
 		//promising state to explore next
 		curr_state = dequeue(fringe);
 
-		//Check to see if we have found the solution. If we did, we will print out the solution path and stop
+		//Check to see if we have found the solution. If we did, we can stop
 		if(states_same(curr_state, goal_state, N)){
-			//Stop the clock if we find a solution
-			clock_t end_CPU = clock();
-
-			//Determine the time spent on the CPU
-			double time_spent_CPU = (double)(end_CPU - begin_CPU) / CLOCKS_PER_SEC;
+			options->statistics.expanded = iteration;
+			options->statistics.generated = num_unique_configs;
 
-			//Now find the solution path by working backwords
-			//Keep track of how long the path is	
-			int pathlen = 0;
-			//Keep a linked list for our solution path
-			struct state* solution_path = NULL;
-		
-			//Put the states into the solution path in reverse order(insert at the head) using their predecessor
-			while(curr_state != NULL){
-				//Insert the current state at the head of solution path
-				curr_state->next = solution_path;
-				solution_path = curr_state;
-				//Go back up the solution chain using predecessor
-				curr_state = curr_state->predecessor;
-				//Increment the path length
-				pathlen++;
-			}
-
-			//Cleanup the fringe and closed arrays
-			cleanup_fringe_closed(fringe, closed, solution_path, N);
-
-			//If we are in debug mode, print this path to the console
-			if(solver_mode == 1){
-				//Print the path
-				print_solution_path(solution_path, N, pathlen, num_unique_configs, time_spent_CPU);
-				//Cleanup the path
-				cleanup_solution_path(solution_path);
-				//Return nothing, as it isn't used
-				return NULL;
-			}
+			//Cleanup the fringe and closed arrays, the states themselves stay in the arena
+			cleanup_fringe_closed(fringe, closed);
 
 			//We've found a solution, so the function should exit 
-			return solution_path;	
+			return curr_state;	
 		}
 		
 		/**
@@ -248,16 +323,19 @@ struct state* solve(int N, struct state* start_state, struct state* goal_state,
 		 */
 
 		//Generate successors to the current state once we know it isn't a solution
-		generate_successors(fringe, closed, curr_state, successors, N);
+		generate_successors(fringe, closed, arena, curr_state, successors, generated, N, options->expansion, options->heuristic, machine);
 		
 		/* End multi-threading */
 
 		//Add all necessary states to fringe now that we have checked for repeats and updated predictions 
 		//Additionally, we need to update the num_unique_configs, this will be done in merge_to_fringe
-		num_unique_configs += merge_to_fringe(fringe, successors); 
+		num_unique_configs += merge_to_fringe(fringe, successors, N); 
+
+		//Any state that didn't make it into fringe can be reused
+		release_rejected(arena, generated, successors);
 	
 		//Add to closed
-		merge_to_closed(closed, curr_state);
+		merge_to_closed(closed, curr_state, N);
 
 		//For very complex problems, print the iteration count to the console for a sanity check
 		if(solver_mode == 1 && iteration > 1 && iteration % 1000 == 0) {
@@ -267,11 +345,105 @@ struct state* solve(int N, struct state* start_state, struct state* goal_state,
 		//End of one full iteration
 		iteration++;
 	}
-	
-	//If we end up here, fringe became NULL with no goal configuration found, so there is no solution
-	printf("No solution.\n");
+
+	options->statistics.expanded = iteration;
+	options->statistics.generated = num_unique_configs;
 
 	//Cleanup the fringe and closed arrays
-	cleanup_fringe_closed(fringe, closed, NULL, N);
+	cleanup_fringe_closed(fringe, closed);
 	return NULL;
 }
+
+
+/**
+ * Solve the N puzzle with whichever search engine the options ask for. If the solve function is successful, it
+ * will print the resulting solution path to the console as well.  
+ * For mode: 0 equals web client solve, 1 equals debug(CLI) mode
+ */
+struct solution* solve(int N, struct state* start_state, struct state* goal_state, int solver_mode, struct solver_options* options){
+	//If we are in debug mode, we will start off by printing to the console
+	if(solver_mode == 1){
+		printf("\nInitial State:\n");
+		print_state(start_state, N, 0);
+		printf("Goal state\n");
+		print_state(goal_state, N, 0);
+	} 
+
+	//Every state in this solve lives in its own arena
+	struct state_arena* arena = initialize_arena(N);
+
+	//We will keep track of the time taken to execute, both on the CPU and on the wall
+	clock_t begin_CPU = clock();
+	struct timespec begin_wall, end_wall;
+	clock_gettime(CLOCK_MONOTONIC, &begin_wall);
+
+	//Move the start_state into the arena, the solver owns it from here on out
+	struct state* start = arena_allocate_state(arena);
+	copy_state(start_state, start, N);
+	//The start state hasn't traveled at all, so work out its costs from scratch
+	start->current_travel = 0;
+	start->predecessor = NULL;
+	start->move_state = MOVE_PRUNING_START;
+	update_heuristic(start, N, options->heuristic);
+	destroy_state(start_state, N);
+	free(start_state);
+
+	//Every engine but the anytime one only ever finds optimal solutions
+	options->statistics.suboptimality_bound = 1.0;
+
+	//Run the search itself
+	struct state* goal_node;
+	if(options->engine == SOLVER_ENGINE_IDA){
+		goal_node = ida_search(arena, start, goal_state, N, solver_mode, options);
+	} else if(options->engine == SOLVER_ENGINE_HDA){
+		goal_node = hda_search(arena, start, goal_state, N, solver_mode, options);
+	} else if(options->engine == SOLVER_ENGINE_BIDIRECTIONAL){
+		goal_node = bidirectional_search(arena, start, goal_state, N, solver_mode, options);
+	} else if(options->engine == SOLVER_ENGINE_ANYTIME){
+		goal_node = anytime_search(arena, start, goal_state, N, solver_mode, options);
+	} else if(options->engine == SOLVER_ENGINE_PARTIAL_EXPANSION){
+		goal_node = partial_expansion_search(arena, start, goal_state, N, solver_mode, options);
+	} else if(options->engine == SOLVER_ENGINE_REDUCTION){
+		goal_node = reduction_search(arena, start, goal_state, N, solver_mode, options);
+	} else if(options->engine == SOLVER_ENGINE_TABLE){
+		goal_node = table_search(arena, start, goal_state, N, solver_mode, options);
+	} else {
+		goal_node = astar_search(arena, start, goal_state, N, solver_mode, options);
+	}
+
+	//Stop the clock, and record the time spent on the CPU and on the wall
+	clock_t end_CPU = clock();
+	clock_gettime(CLOCK_MONOTONIC, &end_wall);
+	options->statistics.cpu_time = (double)(end_CPU - begin_CPU) / CLOCKS_PER_SEC;
+	options->statistics.wall_time = (end_wall.tv_sec - begin_wall.tv_sec) + (end_wall.tv_nsec - begin_wall.tv_nsec) / 1e9;
+
+	//If we end up here with no goal, the search ran out of states to look at, so there is no solution
+	if(goal_node == NULL){
+		printf("No solution.\n");
+		destroy_arena(arena);
+		return NULL;
+	}
+
+	//Now find the solution path by working backwords, keeping only the moves that it took
+	struct solution* solution = initialize_solution(goal_node, N);
+
+	//Release every search state at once
+	destroy_arena(arena);
+
+	//If we are in debug mode, print this path to the console
+	if(solver_mode == 1){
+		//Make sure that it really does get there first
+		if(verify_solution(solution, goal_state, N) == 0){
+			printf("WARNING: The solution path does not reach the goal state\n");
+		}
+		//Print the path
+		print_solution_path(solution, N, &(options->statistics));
+		//Cleanup the solution
+		destroy_solution(solution);
+		//Return nothing, as it isn't used
+		return NULL;
+	}
+
+	//We've found a solution, so the function should exit 
+	return solution;	
+}
@@ -0,0 +1,153 @@
+/**
+ * Author: Jack Robbins
+ * This file implements partial expansion A* (PEA*). Plain A* puts every successor of a state into the fringe, even
+ * though most of the ones with a higher total_cost than their parent are never taken back out before the goal is
+ * found, and they hold onto their memory until the search is over.
+ *
+ * PEA* makes every successor, but only keeps the ones whose total_cost is no more than the total_cost stored for the
+ * state that it expanded, and gives the others straight back to the arena. If any were left out, the state
+ * goes back into the fringe with the lowest total_cost of those, instead of into closed. Should the search ever get
+ * that far, the state is expanded again and the next group of successors is kept. Every state comes out of the
+ * fringe in the same order as it would for A*, so the solution is just as optimal, and the price is only the extra
+ * expansions
+ */
+
+//For INT_MAX
+#include <limits.h>
+#include "solve_partial_expansion.h"
+
+/**
+ * Make every successor of statePtr, and merge the ones that are no more expensive than statePtr's stored
+ * total_cost into the fringe. Returns the lowest total_cost of the successors that were left out, or INT_MAX if
+ * none were
+ * 0 = left move, 1 = right move, 2 = down move, 3 = up move
+ */
+static int expand_state(struct partial_expansion_search* search, struct state* statePtr){
+	int N = search->N;
+	int next_cost = INT_MAX;
+
+	for(int move = 0; move < 4; move++){
+		//Skip the moves that would take the blank off of the board
+		if((move == 0 && statePtr->zero_column == 0) || (move == 1 && statePtr->zero_column == N - 1)
+		   || (move == 2 && statePtr->zero_row == N - 1) || (move == 3 && statePtr->zero_row == 0)){
+			continue;
+		}
+
+		//A pruned move, like undoing the last one, would only ever lead to a repeat, so don't make it at all
+		int move_state = next_move_state(search->machine, statePtr->move_state, move);
+		if(move_state == MOVE_PRUNED){
+			continue;
+		}
+
+		struct state* successor = arena_allocate_state(search->arena);
+		copy_state(statePtr, successor, N);
+		successor->move_state = move_state;
+
+		if(move == 0){
+			move_left(successor, N);
+		} else if(move == 1){
+			move_right(successor, N);
+		} else if(move == 2){
+			move_down(successor, N);
+		} else {
+			move_up(successor, N);
+		}
+
+		update_heuristic(successor, N, search->heuristic);
+
+		//Anything more expensive waits until statePtr comes back around, and it's made again then
+		if(successor->total_cost > statePtr->total_cost){
+			if(successor->total_cost < next_cost){
+				next_cost = successor->total_cost;
+			}
+			arena_release_state(search->arena, successor);
+			continue;
+		}
+
+		//The usual repeat checks, which also throw out the ones that an earlier expansion of statePtr kept
+		struct state* successors[4] = {successor, NULL, NULL, NULL};
+		check_repeating_closed(search->closed, &(successors[0]), N);
+		check_repeating_fringe(search->fringe, &(successors[0]), N);
+
+		if(successors[0] == NULL){
+			arena_release_state(search->arena, successor);
+			continue;
+		}
+
+		//If this was a cheaper path to a state in the fringe, the fringe copy takes it over
+		int inserted = merge_to_fringe(search->fringe, successors, N);
+		search->generated += inserted;
+
+		if(inserted == 0){
+			arena_release_state(search->arena, successor);
+		}
+	}
+
+	return next_cost;
+}
+
+
+/**
+ * Run PEA* from start until goal_state comes out of the fringe
+ */
+struct state* partial_expansion_search(struct state_arena* arena, struct state* start, struct state* goal_state, const int N,
+									   int solver_mode, struct solver_options* options){
+	struct partial_expansion_search search;
+	struct state* goal_node = NULL;
+
+	search.arena = arena;
+	search.goal_state = goal_state;
+	search.N = N;
+	search.heuristic = options->heuristic;
+	search.machine = move_pruning_machine(N, options->pruning);
+	search.fringe = initialize_fringe(options->fringe);
+	search.closed = initialize_closed();
+	search.expanded = 0;
+	search.generated = 0;
+	search.reinserted = 0;
+	search.peak_fringe = 1;
+
+	priority_queue_insert(search.fringe, start);
+
+	while(!fringe_empty(search.fringe)){
+		struct state* curr_state = dequeue(search.fringe);
+
+		if(states_same(curr_state, goal_state, N)){
+			goal_node = curr_state;
+			break;
+		}
+
+		int next_cost = expand_state(&search, curr_state);
+		search.expanded++;
+
+		//Everything was kept, so this state is done with. Otherwise it waits for the successors that were left out
+		if(next_cost == INT_MAX){
+			merge_to_closed(search.closed, curr_state, N);
+		} else {
+			curr_state->total_cost = next_cost;
+			priority_queue_insert(search.fringe, curr_state);
+			search.reinserted++;
+		}
+
+		if(search.fringe->next_fringe_index > search.peak_fringe){
+			search.peak_fringe = search.fringe->next_fringe_index;
+		}
+
+		//For very complex problems, print the iteration count to the console for a sanity check
+		if(solver_mode == 1 && search.expanded % 1000 == 0){
+			printf("Iteration: %6ld, %6ld total unique states generated\n", search.expanded, search.generated);
+		}
+	}
+
+	if(solver_mode == 1){
+		printf("%ld of %ld expansions left successors out, the fringe held at most %d states\n",
+			   search.reinserted, search.expanded, search.peak_fringe);
+	}
+
+	options->statistics.expanded = search.expanded;
+	options->statistics.generated = search.generated;
+
+	cleanup_fringe_closed(search.fringe, search.closed);
+
+	return goal_node;
+}
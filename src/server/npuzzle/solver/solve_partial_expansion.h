@@ -0,0 +1,43 @@
+/**
+ * Author: Jack Robbins
+ * This header file defines the partial expansion engine, which runs partial expansion A* (PEA*). It finds the same
+ * optimal solutions that A* does, but only ever keeps the successors that are as promising as the state that they
+ * came from, so far fewer states sit in the fringe. The functions are implemented in solve_partial_expansion.c
+ */
+
+#ifndef SOLVE_PARTIAL_EXPANSION_H
+#define SOLVE_PARTIAL_EXPANSION_H
+
+#include "solve.h"
+
+/**
+ * Everything that one partial expansion search keeps track of
+ */
+struct partial_expansion_search {
+	struct state_arena* arena;
+	struct state* goal_state;
+	int N;
+	heuristic_type heuristic;
+	//The moves that are never worth making
+	const struct move_pruning_machine* machine;
+	//A state in the fringe that has already been expanded once keeps the total_cost of the successors that it
+	//left out, so it comes back around once the search gets that far
+	struct fringe* fringe;
+	struct closed* closed;
+	long expanded;
+	long generated;
+	//How many of the expansions put their state back into the fringe, and the most states the fringe ever held
+	long reinserted;
+	int peak_fringe;
+};
+
+
+/**
+ * Run PEA* from start, whose costs must already be filled in, until goal_state is found. Every state comes from the
+ * arena, and the one that is returned is linked back to start through predecessor. Returns NULL if there is no
+ * solution
+ */
+struct state* partial_expansion_search(struct state_arena* arena, struct state* start, struct state* goal_state, const int N,
+									   int solver_mode, struct solver_options* options);
+
+#endif /* SOLVE_PARTIAL_EXPANSION_H */
@@ -0,0 +1,453 @@
+/**
+ * Author: Jack Robbins
+ * This file implements the reduction engine. The top row of the puzzle is placed one tile at a time, then the left
+ * column, which leaves a puzzle one smaller that none of the placed tiles ever need to move for. This repeats until
+ * only REDUCTION_HANDOFF_N by REDUCTION_HANDOFF_N is left, which the usual solver then finishes optimally.
+ *
+ * Every tile is walked to its spot along a shortest path that stays off of the placed tiles, with the blank walked
+ * around in front of it for every step. The last two tiles of a row or a column can't be placed one at a time, so a
+ * small search puts them in together. None of this is optimal, but a 9x9 is done in milliseconds
+ */
+
+#include "solve_reduction.h"
+
+/**
+ * Write down one move of the blank. A move that undoes the one just before it cancels it out instead
+ */
+static void record_move(struct reduction_search* search, const int move){
+	//Left and right undo each other, and so do down and up
+	if(search->num_moves > 0 && search->moves[search->num_moves - 1] == (move ^ 1)){
+		search->num_moves--;
+		return;
+	}
+
+	//Make room if we need to
+	if(search->num_moves == search->max_moves){
+		search->max_moves *= 2;
+		search->moves = realloc(search->moves, search->max_moves);
+	}
+
+	search->moves[search->num_moves] = move;
+	search->num_moves++;
+}
+
+
+/**
+ * Move the blank into next, which must be right beside it. The tile that was in next ends up where the blank was
+ */
+static void move_blank(struct reduction_search* search, const int next){
+	int N = search->N;
+	int move;
+
+	//Work out which way that is
+	if(next == search->blank - 1){
+		move = 0;
+	} else if(next == search->blank + 1){
+		move = 1;
+	} else if(next == search->blank + N){
+		move = 2;
+	} else {
+		move = 3;
+	}
+
+	search->board[search->blank] = search->board[next];
+	search->board[next] = 0;
+	search->blank = next;
+	record_move(search, move);
+}
+
+
+/**
+ * Breadth first search outwards from target, through every cell that isn't fixed and isn't avoid. Afterwards, the
+ * parent of every cell that was reached is the next cell along a shortest path from it to target, and the parent of
+ * every other cell is -1
+ */
+static void search_from(struct reduction_search* search, const int target, const int avoid){
+	int N = search->N;
+	int head = 0;
+	int tail = 0;
+
+	for(int i = 0; i < N * N; i++){
+		search->parent[i] = -1;
+	}
+
+	search->parent[target] = target;
+	search->queue[tail] = target;
+	tail++;
+
+	while(head < tail){
+		int cell = search->queue[head];
+		head++;
+
+		//The cells beside this one, or -1 for the ones that would be off of the board
+		int row = cell / N;
+		int column = cell % N;
+		int neighbors[4] = {column > 0 ? cell - 1 : -1, column < N - 1 ? cell + 1 : -1,
+							row < N - 1 ? cell + N : -1, row > 0 ? cell - N : -1};
+
+		for(int i = 0; i < 4; i++){
+			int neighbor = neighbors[i];
+
+			if(neighbor == -1 || neighbor == avoid || search->fixed[neighbor] == 1 || search->parent[neighbor] != -1){
+				continue;
+			}
+
+			search->parent[neighbor] = cell;
+			search->queue[tail] = neighbor;
+			tail++;
+		}
+	}
+}
+
+
+/**
+ * Walk the blank to target without going through avoid or any fixed cell. Returns 0 on success, or -1 if it can't
+ * get there
+ */
+static int move_blank_to(struct reduction_search* search, const int target, const int avoid){
+	search_from(search, target, avoid);
+
+	if(search->parent[search->blank] == -1){
+		return -1;
+	}
+
+	while(search->blank != target){
+		move_blank(search, search->parent[search->blank]);
+	}
+
+	return 0;
+}
+
+
+/**
+ * Walk tile to target one step at a time, without disturbing any fixed cell. Returns 0 on success, or -1 if it
+ * can't get there
+ */
+static int move_tile_to(struct reduction_search* search, const short tile, const int target){
+	int position = 0;
+
+	//Find where the tile is now
+	while(search->board[position] != tile){
+		position++;
+	}
+
+	while(position != target){
+		//The next step along the tile's own shortest path
+		search_from(search, target, -1);
+		int next = search->parent[position];
+
+		//Get the blank in front of the tile without pushing the tile around, then swap the two of them
+		if(next == -1 || move_blank_to(search, next, position) == -1){
+			return -1;
+		}
+		move_blank(search, position);
+
+		position = next;
+	}
+
+	return 0;
+}
+
+
+/**
+ * Place the last two tiles of a row or a column. Walking one of them in would have to push the other one back out,
+ * so both are walked up close to their spots first, and then a breadth first search over just where the blank and
+ * the two of them are finds the moves that put both in at once. The other tiles aren't fixed and can go anywhere, so
+ * there is always a way. Returns 0 on success, or -1 if it can't be done
+ */
+static int place_pair(struct reduction_search* search, const int first_target, const int second_target){
+	int cells = search->N * search->N;
+	short first = search->goal_tiles[first_target];
+	short second = search->goal_tiles[second_target];
+
+	//Get them both close. Nothing new is fixed yet, so there's no dead end for either of them to get stuck in
+	if(move_tile_to(search, second, second_target) == -1 || move_tile_to(search, first, first_target) == -1){
+		return -1;
+	}
+
+	//Where the blank and the two tiles are now, as one number
+	int first_position = first_target;
+	int second_position = 0;
+	while(search->board[second_position] != second){
+		second_position++;
+	}
+	int start = (search->blank * cells + first_position) * cells + second_position;
+	int goal = -1;
+
+	//Every search gets its own mark, so the marks never need to be cleared
+	(search->pair_generation)++;
+	search->pair_mark[start] = search->pair_generation;
+	search->pair_parent[start] = -1;
+
+	int head = 0;
+	int tail = 0;
+	search->pair_queue[tail] = start;
+	tail++;
+
+	while(head < tail){
+		int current = search->pair_queue[head];
+		head++;
+
+		int blank = current / (cells * cells);
+		int first_at = (current / cells) % cells;
+		int second_at = current % cells;
+
+		if(first_at == first_target && second_at == second_target){
+			goal = current;
+			break;
+		}
+
+		//The blank can go anywhere beside it that isn't fixed, and whichever tile was there takes its place
+		int row = blank / search->N;
+		int column = blank % search->N;
+		int neighbors[4] = {column > 0 ? blank - 1 : -1, column < search->N - 1 ? blank + 1 : -1,
+							row < search->N - 1 ? blank + search->N : -1, row > 0 ? blank - search->N : -1};
+
+		for(int i = 0; i < 4; i++){
+			int neighbor = neighbors[i];
+			if(neighbor == -1 || search->fixed[neighbor] == 1){
+				continue;
+			}
+
+			int next_first = first_at == neighbor ? blank : first_at;
+			int next_second = second_at == neighbor ? blank : second_at;
+			int next = (neighbor * cells + next_first) * cells + next_second;
+
+			if(search->pair_mark[next] == search->pair_generation){
+				continue;
+			}
+
+			search->pair_mark[next] = search->pair_generation;
+			search->pair_parent[next] = current;
+			search->pair_queue[tail] = next;
+			tail++;
+		}
+	}
+
+	if(goal == -1){
+		return -1;
+	}
+
+	//Walk back from the goal to find where the blank went, then make those moves from the start. The queue is
+	//done with, so it can hold them
+	int length = 0;
+	for(int current = goal; current != start; current = search->pair_parent[current]){
+		search->pair_queue[length] = current / (cells * cells);
+		length++;
+	}
+	for(int i = length - 1; i >= 0; i--){
+		move_blank(search, search->pair_queue[i]);
+	}
+
+	search->fixed[first_target] = 1;
+	search->fixed[second_target] = 1;
+
+	return 0;
+}
+
+
+/**
+ * Place the top row and the left column, over and over, until only REDUCTION_HANDOFF_N by REDUCTION_HANDOFF_N is left
+ * in the bottom right corner. Returns 0 on success, or -1 if it can't be done
+ */
+static int reduce(struct reduction_search* search){
+	int N = search->N;
+
+	for(int k = 0; N - k > REDUCTION_HANDOFF_N; k++){
+		//All but the last two tiles of the top row go straight in
+		for(int column = k; column < N - 2; column++){
+			int target = k * N + column;
+			if(move_tile_to(search, search->goal_tiles[target], target) == -1){
+				return -1;
+			}
+			search->fixed[target] = 1;
+		}
+
+		//The last two go in together
+		if(place_pair(search, k * N + N - 2, k * N + N - 1) == -1){
+			return -1;
+		}
+
+		//The same for the left column, whose top tile is already in the row
+		for(int row = k + 1; row < N - 2; row++){
+			int target = row * N + k;
+			if(move_tile_to(search, search->goal_tiles[target], target) == -1){
+				return -1;
+			}
+			search->fixed[target] = 1;
+		}
+
+		//And again, the last two go in together
+		if(place_pair(search, (N - 2) * N + k, (N - 1) * N + k) == -1){
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+
+/**
+ * Hand what's left over in the bottom right corner to the usual solver as a puzzle of its own, and carry its solution
+ * back over to the full board. Returns 0 on success, or -1 if there is no solution
+ */
+static int finish(struct reduction_search* search, struct solver_options* options){
+	int N = search->N;
+	int M = N < REDUCTION_HANDOFF_N ? N : REDUCTION_HANDOFF_N;
+	int offset = N - M;
+
+	//Number the tiles by where they belong in the smaller puzzle. The blank's spot is the last one in both
+	struct state* start = (struct state*)malloc(sizeof(struct state));
+	initialize_state(start, M);
+
+	for(int i = 0; i < M; i++){
+		for(int j = 0; j < M; j++){
+			short tile = search->board[(offset + i) * N + offset + j];
+			short renumbered = 0;
+
+			if(tile == 0){
+				start->zero_row = i;
+				start->zero_column = j;
+			} else {
+				int goal = search->goal_index[tile];
+				renumbered = (goal / N - offset) * M + (goal % N - offset) + 1;
+			}
+
+			set_tile(start, i * M + j, renumbered, M);
+		}
+	}
+	start->hash = hash_state(start, M);
+
+	struct state* goal = initialize_goal(M);
+
+	//Something this small isn't worth the expansion pool
+	struct solver_options finish_options = default_solver_options(M);
+	finish_options.expansion = EXPANSION_INLINE;
+
+	//The solver takes start over
+	struct solution* solution = solve(M, start, goal, 0, &finish_options);
+
+	options->statistics.expanded = finish_options.statistics.expanded;
+	options->statistics.generated = finish_options.statistics.generated;
+
+	destroy_state(goal, M);
+	free(goal);
+
+	//The tiles that we placed can't have made an unsolvable puzzle out of a solvable one
+	if(solution == NULL){
+		return -1;
+	}
+
+	//Make the same moves on the full board
+	for(int i = 0; i < solution->num_moves; i++){
+		if(solution->moves[i] == SOLUTION_MOVE_LEFT){
+			move_blank(search, search->blank - 1);
+		} else if(solution->moves[i] == SOLUTION_MOVE_RIGHT){
+			move_blank(search, search->blank + 1);
+		} else if(solution->moves[i] == SOLUTION_MOVE_DOWN){
+			move_blank(search, search->blank + N);
+		} else {
+			move_blank(search, search->blank - N);
+		}
+	}
+
+	destroy_solution(solution);
+
+	return 0;
+}
+
+
+/**
+ * Solve the puzzle from start by reduction, and make the states of the solution out of the moves that it took
+ */
+struct state* reduction_search(struct state_arena* arena, struct state* start, struct state* goal_state, const int N,
+							   int solver_mode, struct solver_options* options){
+	struct reduction_search search;
+
+	//If we're already there, there's nothing to do
+	if(states_same(start, goal_state, N)){
+		options->statistics.expanded = 0;
+		options->statistics.generated = 0;
+		options->statistics.suboptimality_bound = 1.0;
+		return start;
+	}
+
+	search.N = N;
+	search.board = malloc(sizeof(short) * N * N);
+	search.blank = start->zero_row * N + start->zero_column;
+	search.goal_tiles = malloc(sizeof(short) * N * N);
+	search.goal_index = malloc(sizeof(int) * N * N);
+	search.fixed = calloc(N * N, sizeof(char));
+	search.queue = malloc(sizeof(int) * N * N);
+	search.parent = malloc(sizeof(int) * N * N);
+	search.moves = malloc(REDUCTION_MOVES_START_SIZE);
+	//Room for every place that the blank and the two tiles of a pair could be
+	search.pair_mark = calloc(N * N * N * N * N * N, sizeof(int));
+	search.pair_parent = malloc(sizeof(int) * N * N * N * N * N * N);
+	search.pair_queue = malloc(sizeof(int) * N * N * N * N * N * N);
+	search.pair_generation = 0;
+	search.num_moves = 0;
+	search.max_moves = REDUCTION_MOVES_START_SIZE;
+
+	unpack_tiles(start, search.board, N);
+	unpack_tiles(goal_state, search.goal_tiles, N);
+	for(int i = 0; i < N * N; i++){
+		search.goal_index[search.goal_tiles[i]] = i;
+	}
+
+	int result = reduce(&search);
+
+	if(solver_mode == 1 && result == 0){
+		printf("Reduced to a %dx%d puzzle in %d moves\n", REDUCTION_HANDOFF_N, REDUCTION_HANDOFF_N, search.num_moves);
+	}
+
+	if(result == 0){
+		result = finish(&search, options);
+	}
+
+	//Make every state along the way out of the moves
+	struct state* cursor = start;
+	if(result == 0){
+		for(int i = 0; i < search.num_moves; i++){
+			struct state* successor = arena_allocate_state(arena);
+			copy_state(cursor, successor, N);
+
+			if(search.moves[i] == 0){
+				move_left(successor, N);
+			} else if(search.moves[i] == 1){
+				move_right(successor, N);
+			} else if(search.moves[i] == 2){
+				move_down(successor, N);
+			} else {
+				move_up(successor, N);
+			}
+
+			update_heuristic(successor, N, options->heuristic);
+			cursor = successor;
+		}
+	}
+
+	//Manhattan distance plus 2 for every tile that has to leave its line only counts moves that have to be made, so no
+	//solution can be shorter than what it says for the start state. It's worked out again here, so that the bound
+	//never depends on whichever heuristic the solve was handed
+	update_prediction_function(start, N);
+	int lower_bound = start->heuristic_cost;
+
+	options->statistics.suboptimality_bound = 1.0;
+	if(lower_bound > 0 && search.num_moves > lower_bound){
+		options->statistics.suboptimality_bound = (double)search.num_moves / lower_bound;
+	}
+
+	free(search.board);
+	free(search.goal_tiles);
+	free(search.goal_index);
+	free(search.fixed);
+	free(search.queue);
+	free(search.parent);
+	free(search.moves);
+	free(search.pair_mark);
+	free(search.pair_parent);
+	free(search.pair_queue);
+
+	return result == 0 ? cursor : NULL;
+}
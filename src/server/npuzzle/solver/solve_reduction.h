@@ -0,0 +1,58 @@
+/**
+ * Author: Jack Robbins
+ * This header file defines the reduction engine, which solves puzzles that are far too big for any search by
+ * placing the top row and the left column, and then doing the same for the smaller puzzle that is left over. Once
+ * that is small enough, an optimal search finishes it off. The functions are implemented in solve_reduction.c
+ */
+
+#ifndef SOLVE_REDUCTION_H
+#define SOLVE_REDUCTION_H
+
+//The size of the puzzle that is left over for the optimal search to finish
+#define REDUCTION_HANDOFF_N 3
+//How many moves the move list starts out with room for
+#define REDUCTION_MOVES_START_SIZE 1024
+
+#include "solve.h"
+
+/**
+ * Everything that one reduction keeps track of. The tiles are moved around on a plain board, and every move of the
+ * blank is written down, so that the states of the solution only have to be made once at the very end
+ */
+struct reduction_search {
+	int N;
+	//The board, in row-major order, and the index of the blank on it
+	short* board;
+	int blank;
+	//The tile that belongs in every cell, and the cell that every tile belongs in
+	short* goal_tiles;
+	int* goal_index;
+	//1 for every cell whose tile has been placed for good, which nothing may move through
+	char* fixed;
+	//Scratch space for the breadth first searches, the cells in the order they were found and the cell that every
+	//one of them was found from
+	int* queue;
+	int* parent;
+	//Every move of the blank so far, 0 = left move, 1 = right move, 2 = down move, 3 = up move
+	char* moves;
+	int num_moves;
+	int max_moves;
+	//Scratch space for placing the last two tiles of a row or column, indexed by where the blank and both tiles
+	//are. Every search marks what it has seen with its own generation
+	int* pair_mark;
+	int* pair_parent;
+	int* pair_queue;
+	int pair_generation;
+};
+
+
+/**
+ * Solve the puzzle from start, whose costs must already be filled in, by reduction. goal_state must have its
+ * blank in the bottom right corner, like the one that initialize_goal makes. Every state comes from the arena, and
+ * the one that is returned is linked back to start through predecessor. The most that the solution can be off of
+ * optimal by, as a factor, is put into the statistics. Returns NULL if there is no solution
+ */
+struct state* reduction_search(struct state_arena* arena, struct state* start, struct state* goal_state, const int N,
+							   int solver_mode, struct solver_options* options);
+
+#endif /* SOLVE_REDUCTION_H */
@@ -0,0 +1,229 @@
+/**
+ * Author: Jack Robbins
+ * This file implements the distance table engine for the 3x3 puzzle. Every layout of the tiles is numbered by its
+ * rank among all 9! permutations, which packs them into one byte each with no gaps and no collisions. The table is
+ * filled in by a breadth first search out from the goal, so the first time that a layout is reached is along one
+ * of its shortest paths, and the move back the way that the search came is a best move out of it.
+ *
+ * A solve looks up its start, makes the best move, and does it again until it gets to the goal. Every step is one
+ * more move of the solution, so there's nothing to search and nothing to throw away
+ */
+
+#include "solve_table.h"
+#include "solve_partial_expansion.h"
+
+//The table itself, which is only ever read once it's built
+static unsigned char* distance_table = NULL;
+
+//How many layouts of the tiles that come after every position there are, (8 - position)!
+static const int factorials[DISTANCE_TABLE_N * DISTANCE_TABLE_N] = {40320, 5040, 720, 120, 24, 6, 2, 1, 1};
+
+
+/**
+ * The rank of a layout among all of the permutations of the tiles, which is its index in the table. Every tile
+ * adds how many of the smaller tiles are still left over after it, times how many ways the rest can be laid out
+ */
+static int rank_tiles(const unsigned char* tiles){
+	int rank = 0;
+	//Every tile that has already been seen gets its bit set
+	unsigned int seen = 0;
+
+	for(int i = 0; i < DISTANCE_TABLE_N * DISTANCE_TABLE_N; i++){
+		int tile = tiles[i];
+		rank += (tile - __builtin_popcount(seen & ((1u << tile) - 1))) * factorials[i];
+		seen |= 1u << tile;
+	}
+
+	return rank;
+}
+
+
+/**
+ * Where the blank ends up after move, or -1 if it would go off of the board
+ * 0 = left move, 1 = right move, 2 = down move, 3 = up move
+ */
+static int move_target(const int blank, const int move){
+	int row = blank / DISTANCE_TABLE_N;
+	int column = blank % DISTANCE_TABLE_N;
+
+	if(move == 0){
+		return column == 0 ? -1 : blank - 1;
+	} else if(move == 1){
+		return column == DISTANCE_TABLE_N - 1 ? -1 : blank + 1;
+	} else if(move == 2){
+		return row == DISTANCE_TABLE_N - 1 ? -1 : blank + DISTANCE_TABLE_N;
+	} else {
+		return row == 0 ? -1 : blank - DISTANCE_TABLE_N;
+	}
+}
+
+
+/**
+ * Fill in the table with a breadth first search out from the goal. Every layout in the queue is packed into one
+ * word, 4 bits for every tile and the blank's spot above them
+ */
+int initialize_distance_table(void){
+	//Only ever build it once
+	if(distance_table != NULL){
+		return 0;
+	}
+
+	unsigned char* table = malloc(DISTANCE_TABLE_SIZE);
+	//Only half of the layouts can ever be reached, so the queue never holds more than that
+	u_int64_t* queue = malloc(sizeof(u_int64_t) * (DISTANCE_TABLE_SIZE / 2));
+
+	if(table == NULL || queue == NULL){
+		free(table);
+		free(queue);
+		return -1;
+	}
+
+	memset(table, DISTANCE_TABLE_UNREACHED, DISTANCE_TABLE_SIZE);
+
+	//The goal has the tiles in order with the blank last
+	unsigned char tiles[DISTANCE_TABLE_N * DISTANCE_TABLE_N];
+	u_int64_t goal = 0;
+	for(int i = 0; i < DISTANCE_TABLE_N * DISTANCE_TABLE_N - 1; i++){
+		tiles[i] = i + 1;
+		goal |= (u_int64_t)(i + 1) << (i * 4);
+	}
+	tiles[DISTANCE_TABLE_N * DISTANCE_TABLE_N - 1] = 0;
+	goal |= (u_int64_t)(DISTANCE_TABLE_N * DISTANCE_TABLE_N - 1) << 36;
+
+	//The goal is where every path ends, so it has no best move
+	table[rank_tiles(tiles)] = 0;
+	queue[0] = goal;
+	int head = 0;
+	int tail = 1;
+
+	while(head < tail){
+		u_int64_t packed = queue[head++];
+		int blank = packed >> 36;
+
+		for(int i = 0; i < DISTANCE_TABLE_N * DISTANCE_TABLE_N; i++){
+			tiles[i] = (packed >> (i * 4)) & 0xF;
+		}
+
+		int distance = table[rank_tiles(tiles)] & ((1 << DISTANCE_TABLE_DISTANCE_BITS) - 1);
+
+		for(int move = 0; move < 4; move++){
+			int target = move_target(blank, move);
+			if(target == -1){
+				continue;
+			}
+
+			//Slide the tile over into the blank, look the new layout up, and slide it back
+			tiles[blank] = tiles[target];
+			tiles[target] = 0;
+			int rank = rank_tiles(tiles);
+			tiles[target] = tiles[blank];
+			tiles[blank] = 0;
+
+			if(table[rank] != DISTANCE_TABLE_UNREACHED){
+				continue;
+			}
+
+			//The way back toward the goal undoes this move, and every move and its inverse only differ in the lowest bit
+			table[rank] = (distance + 1) | ((move ^ 1) << DISTANCE_TABLE_DISTANCE_BITS);
+
+			u_int64_t tile = (packed >> (target * 4)) & 0xF;
+			u_int64_t successor = packed & ~(((u_int64_t)0xF << (target * 4)) | ((u_int64_t)0xF << 36));
+			successor |= (tile << (blank * 4)) | ((u_int64_t)target << 36);
+			queue[tail++] = successor;
+		}
+	}
+
+	free(queue);
+
+	distance_table = table;
+	return 0;
+}
+
+
+/**
+ * Returns 1 if the distance table is ready to use, 0 otherwise
+ */
+int distance_table_loaded(void){
+	return distance_table != NULL;
+}
+
+
+/**
+ * Returns 1 if goal_state has the tiles in order with the blank last, the only goal that the table was built for
+ */
+static int is_table_goal(struct state* goal_state){
+	for(int i = 0; i < DISTANCE_TABLE_N * DISTANCE_TABLE_N - 1; i++){
+		if(get_tile(goal_state, i, DISTANCE_TABLE_N) != i + 1){
+			return 0;
+		}
+	}
+
+	return get_tile(goal_state, DISTANCE_TABLE_N * DISTANCE_TABLE_N - 1, DISTANCE_TABLE_N) == 0;
+}
+
+
+/**
+ * Follow the best moves in the table from start to the goal
+ */
+struct state* table_search(struct state_arena* arena, struct state* start, struct state* goal_state, const int N,
+						   int solver_mode, struct solver_options* options){
+	//Anything that the table can't answer gets searched for as usual
+	if(N != DISTANCE_TABLE_N || distance_table == NULL || is_table_goal(goal_state) == 0){
+		return partial_expansion_search(arena, start, goal_state, N, solver_mode, options);
+	}
+
+	unsigned char tiles[DISTANCE_TABLE_N * DISTANCE_TABLE_N];
+	for(int i = 0; i < N * N; i++){
+		tiles[i] = get_tile(start, i, N);
+	}
+	int blank = start->zero_row * N + start->zero_column;
+
+	unsigned char entry = distance_table[rank_tiles(tiles)];
+
+	options->statistics.expanded = 0;
+	options->statistics.generated = 0;
+
+	//Half of the layouts can never get to the goal
+	if(entry == DISTANCE_TABLE_UNREACHED){
+		return NULL;
+	}
+
+	int distance = entry & ((1 << DISTANCE_TABLE_DISTANCE_BITS) - 1);
+	struct state* curr_state = start;
+
+	for(int step = 0; step < distance; step++){
+		int move = entry >> DISTANCE_TABLE_DISTANCE_BITS;
+		int target = move_target(blank, move);
+
+		struct state* successor = arena_allocate_state(arena);
+		copy_state(curr_state, successor, N);
+
+		if(move == 0){
+			move_left(successor, N);
+		} else if(move == 1){
+			move_right(successor, N);
+		} else if(move == 2){
+			move_down(successor, N);
+		} else {
+			move_up(successor, N);
+		}
+
+		//Keep our own copy of the tiles up to date, so the next lookup doesn't have to read them back out
+		tiles[blank] = tiles[target];
+		tiles[target] = 0;
+		blank = target;
+
+		entry = distance_table[rank_tiles(tiles)];
+		curr_state = successor;
+	}
+
+	if(solver_mode == 1){
+		printf("Looked up all %d moves in the distance table\n", distance);
+	}
+
+	//Every state along the way was made and looked at exactly once
+	options->statistics.expanded = distance;
+	options->statistics.generated = distance;
+
+	return curr_state;
+}
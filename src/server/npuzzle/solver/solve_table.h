@@ -0,0 +1,46 @@
+/**
+ * Author: Jack Robbins
+ * This header file defines the distance table engine for the 3x3 puzzle. There are only 9! ways to lay out its
+ * tiles, so the optimal distance to the goal and the best move to get closer are worked out ahead of time for every
+ * one of them, and a solve only ever follows the best moves from its start. The functions are implemented in
+ * solve_table.c
+ */
+
+#ifndef SOLVE_TABLE_H
+#define SOLVE_TABLE_H
+
+//The only size of puzzle that the table is built for
+#define DISTANCE_TABLE_N 3
+//Every layout of the tiles has its own entry, 9!
+#define DISTANCE_TABLE_SIZE 362880
+//The entry of a layout that can't reach the goal, which is half of them
+#define DISTANCE_TABLE_UNREACHED 0xFF
+//The low bits of an entry hold the distance, which is never more than 31 for the 3x3, and the two above them hold
+//the best move, 0 = left move, 1 = right move, 2 = down move, 3 = up move
+#define DISTANCE_TABLE_DISTANCE_BITS 5
+
+#include "solve.h"
+
+/**
+ * Build the distance table with a breadth first search out from the goal. It only takes a few milliseconds, so it
+ * is done every time a process starts up instead of being cached in a file. This is not thread safe, so it should be
+ * called before anything is solved. Returns 0 on success and -1 on failure
+ */
+int initialize_distance_table(void);
+
+/**
+ * Returns 1 if the distance table is ready to use, 0 otherwise
+ */
+int distance_table_loaded(void);
+
+/**
+ * Solve the 3x3 from start, whose costs must already be filled in, by following the best move out of every state
+ * until the goal is reached. No search is ever run, so it takes one step for every move of the solution. Every
+ * state comes from the arena, and the one that is returned is linked back to start through predecessor. If the
+ * table isn't loaded, or goal_state isn't the usual goal, PEA* solves it instead. Returns NULL if there is no
+ * solution
+ */
+struct state* table_search(struct state_arena* arena, struct state* start, struct state* goal_state, const int N,
+						   int solver_mode, struct solver_options* options);
+
+#endif /* SOLVE_TABLE_H */
@@ -9,6 +9,12 @@
 
 //Global variable that holds our socket here
 int server_socket;
+//Set by the signal handler on <CTRL-C>, which stops the server from taking any more connections
+static volatile sig_atomic_t shutting_down = 0;
+//How many connection threads are still running, so that shutting down can wait for them to finish
+static int active_connections = 0;
+static pthread_mutex_t connections_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t connections_finished = PTHREAD_COND_INITIALIZER;
 
 
 /**
@@ -108,11 +114,11 @@ static void* handle_request(void* server_thread_params){
 	//Cast appropriately
 	struct server_thread_params* params = (struct server_thread_params*)(server_thread_params);
 
-	//Receive data from a connection
-	params->bytes_read = recv(params->inbound_socket, params->buffer, BUFFER, 0);
+	//Receive data from a connection, leaving room for the null terminator
+	params->bytes_read = recv(params->inbound_socket, params->buffer, BUFFER - 1, 0);
 	
-	//If we didn't read anything, we will close the socket and leave
-	if(params->bytes_read < 0){
+	//If we didn't read anything, we will close the socket and leave. A client that hung up sent nothing either
+	if(params->bytes_read <= 0){
 		printf("No data received from client\n");
 
 		//Shutdown the socket
@@ -127,6 +133,9 @@ static void* handle_request(void* server_thread_params){
 		return NULL;
 	}
 
+	//params comes straight from malloc, so the last connection's request may still be sitting past what we just read
+	params->buffer[params->bytes_read] = '\0';
+
 	//If we get here, we know that we got a response that needs to be parsed
 	params->request_details = parse_request(params->buffer);
 
@@ -154,10 +163,14 @@ static void* handle_request(void* server_thread_params){
 		//A post request means that we want to solve the entire puzzle
 		case R_POST:
 			printf("Received a POST request\n");
-			printf("N: %d Complexity: %d \n", params->request_details->N, params->request_details->complexity);
+
+			//Use the seed that was asked for, or pick a new one. It's logged either way, so the same puzzle can be made again
+			u_int64_t seed = params->request_details->has_seed == 1 ? params->request_details->seed : random_seed();
+			printf("N: %d Complexity: %d Seed: %llu\n", params->request_details->N, params->request_details->complexity,
+				   (unsigned long long)seed);
 
 			//Generate the initial starting config
-			params->initial = generate_start_config(params->request_details->complexity, params->request_details->N);
+			params->initial = generate_start_config(params->request_details->complexity, params->request_details->N, seed);
 			//Generate the goal config too
 			params->goal = initialize_goal(params->request_details->N);
 
@@ -180,11 +193,63 @@ static void* handle_request(void* server_thread_params){
 				return NULL;
 			}
 
-			//Attempt to solve the puzzle
-			struct state* solution_path = solve(params->request_details->N, params->initial, params->goal, 0);
+			//This puzzle, or its mirror image, may well have been solved already
+			double suboptimality_bound = 1.0;
+			struct solution* solution = solution_cache_lookup(params->initial, params->request_details->N, &suboptimality_bound);
+			int cache_hit = solution != NULL;
+
+			if(cache_hit == 1){
+				//The solver would have taken the initial state over, so it's up to us to free it
+				destroy_state(params->initial, params->request_details->N);
+				free(params->initial);
+			} else {
+				//Another connection may be solving this very puzzle right now
+				int leader;
+				struct solve_flight* flight = begin_solve_flight(params->initial, params->request_details->N, &leader);
+
+				if(leader == 0){
+					printf("Waiting on the same puzzle to be solved by another connection\n");
+					//Share its result instead of solving it again. We never handed the initial state to the solver
+					solution = wait_for_solve_flight(flight, params->initial, params->request_details->N, &suboptimality_bound);
+					destroy_state(params->initial, params->request_details->N);
+					free(params->initial);
+				} else {
+					//A solve for this puzzle may have finished between our miss and now, and taken itself out of the
+					//registry already. It always caches its solution before that, so looking again closes the gap
+					solution = solution_cache_recheck(params->initial, params->request_details->N, &suboptimality_bound);
+
+					if(solution != NULL){
+						cache_hit = 1;
+						destroy_state(params->initial, params->request_details->N);
+						free(params->initial);
+					} else {
+						//Use whatever solver options are best for this N
+						struct solver_options options = default_solver_options(params->request_details->N);
+
+						//Attempt to solve the puzzle
+						solution = solve(params->request_details->N, params->initial, params->goal, 0, &options);
+						suboptimality_bound = options.statistics.suboptimality_bound;
+
+						//Keep a copy around for the next time that anyone asks for it, before anyone else can stop waiting
+						if(solution != NULL){
+							solution_cache_insert(solution, params->request_details->N, suboptimality_bound);
+						}
+					}
+
+					//Every connection waiting on this one gets a copy of its own
+					finish_solve_flight(flight, solution, suboptimality_bound);
+				}
+			}
+
+			//Let the log show how well the cache is doing
+			struct solution_cache_statistics cache_statistics;
+			get_solution_cache_statistics(&cache_statistics);
+			printf("Solution cache %s: %ld hits, %ld misses, %ld of them found on disk, %ld entries\n",
+				   cache_hit == 1 ? "hit" : "miss", cache_statistics.hits, cache_statistics.misses, cache_statistics.store_hits,
+				   cache_statistics.entries);
 
-			//Construct the solution path
-			params->response = solution_response(params->request_details->N, solution_path);
+			//Construct the solution path, the response builder frees the solution once it's done with it
+			params->response = solution_response(params->request_details->N, solution, suboptimality_bound);
 
 
 			//Send the final response
@@ -217,7 +282,26 @@ static void* handle_request(void* server_thread_params){
 
 	//Exit the thread
 	printf("Request handled successfully.\n");
-	pthread_exit(NULL);
+	return NULL;
+}
+
+
+/**
+ * Handle one connection, and let the server know once it's done so that it can shut down cleanly
+ *
+ * THREAD_ENTRY_POINT
+ */
+static void* connection_thread(void* server_thread_params){
+	handle_request(server_thread_params);
+
+	pthread_mutex_lock(&connections_lock);
+	active_connections--;
+	if(active_connections == 0){
+		pthread_cond_broadcast(&connections_finished);
+	}
+	pthread_mutex_unlock(&connections_lock);
+
+	return NULL;
 }
 
 
@@ -225,15 +309,12 @@ static void* handle_request(void* server_thread_params){
  * Signal interrupt handler to enable a graceful exit on CTRL-C
  */
 static void sigint_handler(const int sig_num){
-	//Let the user know what is happening
-	printf("\nServer closing on <CTRL-C>(Signal Interrupt %d)\nAll sockets closing\n", sig_num);
+	(void)sig_num;
 
-	//Shutdown and close the socket
+	//This could land on a thread that holds any lock at all, so only do what is safe in a signal handler. The
+	//accept loop sees the flag once shutting the socket down wakes it up, and does the rest of the work
+	shutting_down = 1;
 	shutdown(server_socket, SHUT_RDWR);
-	close(server_socket);
-
-	//Exit the program with code 0
-	exit(0);
 }
 
 
@@ -298,12 +379,17 @@ void run(struct Server* server){
 	//Listen for a <CTRL-C> signal and use the handler to perform graceful shutdown
 	signal(SIGINT, sigint_handler);
 
-	//Listen for new connections
- 	while(1){
+	//Listen for new connections until <CTRL-C>
+ 	while(shutting_down == 0){
 		//Grab the length of our socket's address
 		int address_length = sizeof(server->socket_addr);
 		//Accept a new connection and create a new connected socket
 		int new_socket = accept(server->socket, (struct sockaddr*)(&server->socket_addr), (socklen_t*)(&address_length));
+
+		//Shutting down makes accept fail, and a failed connection has nothing to hand off
+		if(new_socket < 0){
+			continue;
+		}
 	
 		//Stack allocate a thread paramater structure
  		struct server_thread_params* params = (struct server_thread_params*)malloc(sizeof(struct server_thread_params));
@@ -320,7 +406,31 @@ void run(struct Server* server){
 		//Allocate a new thread;
 		pthread_t request_handler;
 
-		//Create the thread to handle the request
-		pthread_create(&request_handler, NULL, handle_request, params);
+		//Count it before it starts, so that shutting down can never miss it
+		pthread_mutex_lock(&connections_lock);
+		active_connections++;
+		pthread_mutex_unlock(&connections_lock);
+
+		//Create the thread to handle the request. Nothing ever joins it, so it cleans up after itself
+		pthread_create(&request_handler, NULL, connection_thread, params);
+		pthread_detach(request_handler);
+	}
+
+	//Let the user know what is happening
+	printf("\nServer closing on <CTRL-C>(Signal Interrupt %d)\nAll sockets closing\n", SIGINT);
+
+	//Every connection that was already taken gets to finish
+	pthread_mutex_lock(&connections_lock);
+	while(active_connections > 0){
+		pthread_cond_wait(&connections_finished, &connections_lock);
 	}
+	pthread_mutex_unlock(&connections_lock);
+
+	//Give a final account of how much solving the cache saved, now that nothing else is using it
+	struct solution_cache_statistics cache_statistics;
+	get_solution_cache_statistics(&cache_statistics);
+	printf("Solution cache: %ld hits, %ld misses, %ld of them found on disk, %ld evictions\n", cache_statistics.hits,
+		   cache_statistics.misses, cache_statistics.store_hits, cache_statistics.evictions);
+
+	close(server_socket);
 }
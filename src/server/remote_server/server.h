@@ -26,7 +26,10 @@
 #include "../response_builder/response_builder.h"
 #include "../http_parser/parser.h"
 #include "../npuzzle/puzzle/puzzle.h"
+#include "../npuzzle/puzzle/random_generator.h"
 #include "../npuzzle//solver//solve.h"
+#include "../solution_cache/solution_cache.h"
+#include "../solution_cache/solve_registry.h"
 
 /**
  * Define a struct for a server that contains all of the needed information 
@@ -66,7 +69,7 @@ struct server_thread_params{
 struct Server create_server(u_int32_t domain, u_int32_t port, u_int32_t service, u_int32_t protocol, u_int32_t backlog, u_int64_t interface);
 
 /**
- * Runs the server on a separate thread
+ * Runs the server on a separate thread, until <CTRL-C> is pressed and every connection it took has been handled
  *
  * THREAD_ENTRY_POINT
  */
@@ -54,7 +54,7 @@ static char* construct_grid_display(const int N, struct state* state_ptr){
 		//Wipe the grid item string
 		memset(grid_item, 0, 50);
 		//Print the div item into it
-		sprintf(grid_item, "<div class=\"grid_item\">%d</div>\r\n", state_ptr->tiles[i]);
+		sprintf(grid_item, "<div class=\"grid_item\">%d</div>\r\n", get_tile(state_ptr, i, N));
 
 		//Concatenate the new grid item onto the grid string
 		strcat(grid_display, grid_item); 
@@ -136,6 +136,8 @@ struct response* initial_landing_response(){
   			 			       "<input type=\"text\" maxlength = \"1\" id=\"N\" name=\"N\" placeholder=\"N\"><br><br>\r\n"
 			 				   "<label for = \"complexity\">Enter a value for the complexity of the initial configuration:</label>\r\n"
   							   "<input type=\"text\" maxlength = \"3\" id=\"CMP\" name=\"complexity\" placeholder=\"Complexity\"><br><br>\r\n"
+			 				   "<label for = \"seed\">Optionally, enter a seed to make the same configuration again:</label>\r\n"
+  							   "<input type=\"text\" maxlength = \"20\" id=\"seed\" name=\"seed\" placeholder=\"Seed\"><br><br>\r\n"
 							   "<input type=\"submit\" value=\"Generate Start Configuration and Solve\">\r\n"
 			 				   "</form>\r\n"
              				   "</body>\r\n"
@@ -195,47 +197,76 @@ struct response* initial_config_response(const int N, struct state* state_ptr){
 
 
 /**
- * Construct the response that shows the full solution path
+ * Construct the response that shows the full solution path, along with how far from optimal it could be
  */
-struct response* solution_response(const int N, struct state* solution_path){
+struct response* solution_response(const int N, struct solution* solution, double suboptimality_bound){
 	//Allocated response
 	struct response* response = (struct response*)malloc(sizeof(struct response));
 	
-	//Get some space for our response
-	response->html = (char*)malloc(RESPONSE_SIZE);
+	//Get some space for our response. A long solution on a large board needs far more than this, so we keep track
+	//of how much we have and grow it as we go
+	size_t html_size = RESPONSE_SIZE;
+	response->html = (char*)malloc(html_size);
 
 	//Add in the initial headings
-	sprintf(response->html, "<h2>Solution Found!</h2><br>\r\n"
-							   "<h2>Solution Path</h2><br>\r\n");	
+	if(solution == NULL){
+		sprintf(response->html, "<h2>No solution could be found in time</h2><br>\r\n");
+	} else if(suboptimality_bound > 1.0){
+		sprintf(response->html, "<h2>Solution Found!</h2><br>\r\n"
+								   "<h2>Solution Path (at most %.2f times as long as the shortest one)</h2><br>\r\n", suboptimality_bound);
+	} else {
+		sprintf(response->html, "<h2>Solution Found!</h2><br>\r\n"
+								   "<h2>Solution Path</h2><br>\r\n");	
+	}
+	size_t html_length = strlen(response->html);
 
 	//Set these as warnings to the resonse deconstructor
 	response->grid = NULL;
 	response->style = NULL;
 
-	//Define a cursor to traverse our linked list
-	struct state* cursor = solution_path;
+	//The closing tags that go at the very end
+	const char* closing = "</body>\r\n</html>\r\n\r\n";
+
+	//Replay the solution one state at a time, there's no need for all of them at once
+	struct solution_iterator iterator;
+	int more = 0;
+	if(solution != NULL){
+		initialize_solution_iterator(&iterator, solution, N);
+		more = 1;
+	}
 	
 	//Traverse the solution path
-	while(cursor != NULL){
+	while(more == 1){
 		//If we have a previous grid, we need to free it or else we'll leak
 		if(response->grid != NULL){
 			free(response->grid);
 		}
 		//Remake the new grid 
-		response->grid = construct_grid_display(N,cursor);
+		response->grid = construct_grid_display(N, &(iterator.current));
+		size_t grid_length = strlen(response->grid);
 
-		//Add the grid into our response
-		strcat(response->html, response->grid);
+		//Make sure that there's room for the grid and the closing tags
+		if(html_length + grid_length + strlen(closing) >= html_size){
+			html_size = 2 * html_size + grid_length;
+			response->html = (char*)realloc(response->html, html_size);
+		}
+
+		//Add the grid into our response, we know where the end is so there's no need for strcat to find it
+		memcpy(response->html + html_length, response->grid, grid_length + 1);
+		html_length += grid_length;
 
-		//Advance the linked list
-		cursor = cursor->next;
+		//Advance to the next state
+		more = solution_iterator_next(&iterator, N);
 	}
 
 	//Close the entire thing up
-	strcat(response->html, "</body>\r\n</html>\r\n\r\n");
+	strcat(response->html + html_length, closing);
 
-	//Cleanup the solution path
-	cleanup_solution_path(solution_path);
+	//Cleanup the solution
+	if(solution != NULL){
+		cleanup_solution_iterator(&iterator);
+		destroy_solution(solution);
+	}
 
 	//Give the response back
 	return response;
@@ -9,6 +9,7 @@
 #define RESPONSE_SIZE 50000
 
 #include "../npuzzle/puzzle/puzzle.h"
+#include "../npuzzle/puzzle/solution.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -48,9 +49,9 @@ struct response* initial_config_response(const int N, struct state* state_ptr);
 
 /**
  * Serve up the response that shows the entire solution after it's 
- * been found
+ * been found, and how far from optimal it could be
  */
-struct response* solution_response(const int N, struct state* solution);
+struct response* solution_response(const int N, struct solution* solution, double suboptimality_bound);
 
 /**
  * Teardown any dynamically allocated memory components in the response
@@ -0,0 +1,513 @@
+/**
+ * Author: Jack Robbins
+ * This file implements the solution cache. Every start is turned into its canonical layout first, which is hashed to
+ * pick both the shard and the bucket in it, so a lookup only ever takes one lock. Each shard keeps its entries in
+ * least recently used order, and throws out the oldest ones whenever it goes over its share of the memory budget.
+ * Whatever isn't in memory is looked for in the solution store, which never throws anything out
+ */
+
+#include "solution_cache.h"
+
+//Every shard of the cache
+static struct solution_cache_shard shards[SOLUTION_CACHE_SHARDS];
+//Lookups and insertions do nothing until the cache is initialized
+static int cache_initialized = 0;
+
+
+/**
+ * What a tile becomes once the puzzle is flipped over its diagonal. Its goal row and column trade places, and the
+ * blank stays the blank
+ */
+static short flip_tile(const short tile, const int N){
+	if(tile == 0){
+		return 0;
+	}
+
+	return ((tile - 1) % N) * N + (tile - 1) / N + 1;
+}
+
+
+/**
+ * What a move becomes once the puzzle is flipped over its diagonal. Left and up trade places, and so do right and down
+ */
+char flip_solution_move(const char move){
+	if(move == SOLUTION_MOVE_LEFT){
+		return SOLUTION_MOVE_UP;
+	} else if(move == SOLUTION_MOVE_UP){
+		return SOLUTION_MOVE_LEFT;
+	} else if(move == SOLUTION_MOVE_RIGHT){
+		return SOLUTION_MOVE_DOWN;
+	} else {
+		return SOLUTION_MOVE_RIGHT;
+	}
+}
+
+
+/**
+ * Write the canonical layout of statePtr into tiles, which is whichever of it and its flipped version comes first
+ * tile by tile. Returns 1 if that was the flipped one, 0 if it was its own
+ */
+int canonical_solution_tiles(struct state* statePtr, const int N, short* tiles){
+	short* flipped = malloc(sizeof(short) * N * N);
+	unpack_tiles(statePtr, tiles, N);
+
+	for(int row = 0; row < N; row++){
+		for(int column = 0; column < N; column++){
+			flipped[column * N + row] = flip_tile(tiles[row * N + column], N);
+		}
+	}
+
+	int use_flipped = 0;
+	for(int i = 0; i < N * N; i++){
+		if(flipped[i] != tiles[i]){
+			use_flipped = flipped[i] < tiles[i];
+			break;
+		}
+	}
+
+	if(use_flipped == 1){
+		memcpy(tiles, flipped, sizeof(short) * N * N);
+	}
+
+	free(flipped);
+	return use_flipped;
+}
+
+
+/**
+ * Hash a canonical layout with FNV-1a, and mix the result so that its top bits are just as good for picking a
+ * shard as its bottom bits are for picking a bucket
+ */
+u_int64_t hash_canonical_tiles(const short* tiles, const int N){
+	u_int64_t hash = 14695981039346656037ULL ^ (u_int64_t)N;
+
+	for(int i = 0; i < N * N; i++){
+		hash ^= (u_int16_t)tiles[i];
+		hash *= 1099511628211ULL;
+	}
+
+	hash ^= hash >> 33;
+	hash *= 0xFF51AFD7ED558CCDULL;
+	hash ^= hash >> 33;
+
+	return hash;
+}
+
+
+/**
+ * The shard that a hash belongs to
+ */
+static struct solution_cache_shard* shard_for(const u_int64_t hash){
+	return &(shards[hash >> (64 - SOLUTION_CACHE_SHARD_BITS)]);
+}
+
+
+/**
+ * Find the entry for a canonical layout in a shard, or NULL if it isn't there. The shard must be locked
+ */
+static struct solution_cache_entry* find_entry(struct solution_cache_shard* shard, const short* tiles, const int N,
+											   const u_int64_t hash){
+	struct solution_cache_entry* entry = shard->buckets[hash & (shard->num_buckets - 1)];
+
+	while(entry != NULL){
+		if(entry->hash == hash && entry->N == N && memcmp(entry->tiles, tiles, sizeof(short) * N * N) == 0){
+			return entry;
+		}
+		entry = entry->next_in_bucket;
+	}
+
+	return NULL;
+}
+
+
+/**
+ * Take an entry out of its shard's least recently used order. The shard must be locked
+ */
+static void unlink_entry(struct solution_cache_shard* shard, struct solution_cache_entry* entry){
+	if(entry->newer != NULL){
+		entry->newer->older = entry->older;
+	} else {
+		shard->newest = entry->older;
+	}
+
+	if(entry->older != NULL){
+		entry->older->newer = entry->newer;
+	} else {
+		shard->oldest = entry->newer;
+	}
+}
+
+
+/**
+ * Put an entry at the front of its shard's least recently used order. The shard must be locked
+ */
+static void make_newest(struct solution_cache_shard* shard, struct solution_cache_entry* entry){
+	entry->newer = NULL;
+	entry->older = shard->newest;
+
+	if(shard->newest != NULL){
+		shard->newest->newer = entry;
+	} else {
+		shard->oldest = entry;
+	}
+
+	shard->newest = entry;
+}
+
+
+/**
+ * Take an entry out of its bucket. The shard must be locked
+ */
+static void remove_from_bucket(struct solution_cache_shard* shard, struct solution_cache_entry* entry){
+	struct solution_cache_entry** cursor = &(shard->buckets[entry->hash & (shard->num_buckets - 1)]);
+
+	while(*cursor != entry){
+		cursor = &((*cursor)->next_in_bucket);
+	}
+
+	*cursor = entry->next_in_bucket;
+}
+
+
+/**
+ * Double the number of buckets in a shard, and spread its entries back out over them. If there isn't enough memory,
+ * the shard just keeps the buckets that it has. The shard must be locked
+ */
+static void grow_buckets(struct solution_cache_shard* shard){
+	int num_buckets = shard->num_buckets * 2;
+	struct solution_cache_entry** buckets = calloc(num_buckets, sizeof(struct solution_cache_entry*));
+
+	if(buckets == NULL){
+		return;
+	}
+
+	for(int i = 0; i < shard->num_buckets; i++){
+		struct solution_cache_entry* entry = shard->buckets[i];
+
+		while(entry != NULL){
+			struct solution_cache_entry* next = entry->next_in_bucket;
+			int bucket = entry->hash & (num_buckets - 1);
+			entry->next_in_bucket = buckets[bucket];
+			buckets[bucket] = entry;
+			entry = next;
+		}
+	}
+
+	free(shard->buckets);
+	shard->buckets = buckets;
+	shard->num_buckets = num_buckets;
+}
+
+
+/**
+ * Free an entry and everything in it
+ */
+static void destroy_entry(struct solution_cache_entry* entry){
+	free(entry->tiles);
+	free(entry->moves);
+	free(entry);
+}
+
+
+/**
+ * Set up every shard with an equal share of the budget
+ */
+int initialize_solution_cache(const size_t max_bytes){
+	//Only ever set it up once
+	if(cache_initialized == 1){
+		return 0;
+	}
+
+	for(int i = 0; i < SOLUTION_CACHE_SHARDS; i++){
+		struct solution_cache_shard* shard = &(shards[i]);
+
+		shard->buckets = calloc(SOLUTION_CACHE_INITIAL_BUCKETS, sizeof(struct solution_cache_entry*));
+		if(shard->buckets == NULL){
+			//Give back the shards that did get their buckets
+			for(int j = 0; j < i; j++){
+				free(shards[j].buckets);
+				pthread_mutex_destroy(&(shards[j].lock));
+			}
+			return -1;
+		}
+
+		pthread_mutex_init(&(shard->lock), NULL);
+		shard->num_buckets = SOLUTION_CACHE_INITIAL_BUCKETS;
+		shard->num_entries = 0;
+		shard->newest = NULL;
+		shard->oldest = NULL;
+		shard->bytes = 0;
+		shard->max_bytes = max_bytes / SOLUTION_CACHE_SHARDS;
+		shard->hits = 0;
+		shard->store_hits = 0;
+		shard->misses = 0;
+		shard->insertions = 0;
+		shard->evictions = 0;
+	}
+
+	cache_initialized = 1;
+	return 0;
+}
+
+
+/**
+ * Make an entry for a canonical layout, which takes tiles over and copies the moves
+ */
+static struct solution_cache_entry* create_entry(short* tiles, const int N, const u_int64_t hash, const char* moves,
+												 const int num_moves, const double suboptimality_bound){
+	struct solution_cache_entry* entry = malloc(sizeof(struct solution_cache_entry));
+
+	entry->N = N;
+	entry->tiles = tiles;
+	entry->hash = hash;
+	entry->num_moves = num_moves;
+	entry->moves = malloc(num_moves > 0 ? num_moves : 1);
+	memcpy(entry->moves, moves, num_moves);
+	entry->suboptimality_bound = suboptimality_bound;
+	entry->size = sizeof(struct solution_cache_entry) + sizeof(short) * N * N + num_moves;
+
+	return entry;
+}
+
+
+/**
+ * Put an entry into its shard, and throw out whatever it takes to stay within the budget. If from_store is 1, the
+ * entry was found in the solution store, and it's counted as such
+ */
+static void add_entry(struct solution_cache_entry* entry, const int from_store){
+	struct solution_cache_shard* shard = shard_for(entry->hash);
+
+	//Something that could never fit isn't worth throwing everything else out for
+	if(entry->size > shard->max_bytes){
+		destroy_entry(entry);
+		return;
+	}
+
+	//Whatever gets thrown out is freed once the shard is unlocked again
+	struct solution_cache_entry* evicted = NULL;
+
+	pthread_mutex_lock(&(shard->lock));
+
+	if(from_store == 1){
+		(shard->store_hits)++;
+	}
+
+	//Another thread may have solved the same puzzle at the same time, in which case its entry is kept
+	if(find_entry(shard, entry->tiles, entry->N, entry->hash) != NULL){
+		pthread_mutex_unlock(&(shard->lock));
+		destroy_entry(entry);
+		return;
+	}
+
+	int bucket = entry->hash & (shard->num_buckets - 1);
+	entry->next_in_bucket = shard->buckets[bucket];
+	shard->buckets[bucket] = entry;
+	make_newest(shard, entry);
+	(shard->num_entries)++;
+	(shard->insertions)++;
+	shard->bytes += entry->size;
+
+	while(shard->bytes > shard->max_bytes){
+		struct solution_cache_entry* oldest = shard->oldest;
+		unlink_entry(shard, oldest);
+		remove_from_bucket(shard, oldest);
+		(shard->num_entries)--;
+		(shard->evictions)++;
+		shard->bytes -= oldest->size;
+
+		oldest->next_in_bucket = evicted;
+		evicted = oldest;
+	}
+
+	//Keep the buckets short
+	if(shard->num_entries > shard->num_buckets){
+		grow_buckets(shard);
+	}
+
+	pthread_mutex_unlock(&(shard->lock));
+
+	while(evicted != NULL){
+		struct solution_cache_entry* next = evicted->next_in_bucket;
+		destroy_entry(evicted);
+		evicted = next;
+	}
+}
+
+
+/**
+ * Look for a solution to start, first in memory and then in the store, and make a copy of it for start if there is
+ * one. A miss is only counted if count_miss is 1
+ */
+static struct solution* lookup(struct state* start, const int N, double* suboptimality_bound, const int count_miss){
+	if(cache_initialized == 0){
+		return NULL;
+	}
+
+	short* tiles = malloc(sizeof(short) * N * N);
+	int flipped = canonical_solution_tiles(start, N, tiles);
+	u_int64_t hash = hash_canonical_tiles(tiles, N);
+	struct solution_cache_shard* shard = shard_for(hash);
+
+	//The moves are copied out while the shard is locked, since the entry could be thrown out as soon as it isn't
+	char* moves = NULL;
+	int num_moves = 0;
+
+	pthread_mutex_lock(&(shard->lock));
+
+	struct solution_cache_entry* entry = find_entry(shard, tiles, N, hash);
+	if(entry != NULL){
+		(shard->hits)++;
+		unlink_entry(shard, entry);
+		make_newest(shard, entry);
+
+		num_moves = entry->num_moves;
+		moves = malloc(num_moves > 0 ? num_moves : 1);
+		memcpy(moves, entry->moves, num_moves);
+		*suboptimality_bound = entry->suboptimality_bound;
+	} else if(count_miss == 1){
+		(shard->misses)++;
+	}
+
+	pthread_mutex_unlock(&(shard->lock));
+
+	//An earlier run of the server may have solved it
+	struct solution_cache_entry* stored = NULL;
+	if(moves == NULL && solution_store_find(tiles, N, hash, &moves, &num_moves, suboptimality_bound) == 1){
+		stored = create_entry(tiles, N, hash, moves, num_moves, *suboptimality_bound);
+	} else {
+		free(tiles);
+	}
+
+	if(moves == NULL){
+		return NULL;
+	}
+
+	//The cached moves solve the canonical layout, so they have to be flipped back if start is the other one
+	if(flipped == 1){
+		for(int i = 0; i < num_moves; i++){
+			moves[i] = flip_solution_move(moves[i]);
+		}
+	}
+
+	struct solution* solution = initialize_solution_from_moves(start, moves, num_moves, N);
+
+	//The store only checks the layout, so a damaged move has to be caught here. It only ever costs a miss
+	if(stored != NULL){
+		struct state* goal_state = initialize_goal(N);
+		int solves = verify_solution(solution, goal_state, N);
+		destroy_state(goal_state, N);
+		free(goal_state);
+
+		if(solves == 0){
+			destroy_entry(stored);
+			destroy_solution(solution);
+			return NULL;
+		}
+
+		//It's kept in memory from now on too
+		add_entry(stored, 1);
+	}
+
+	return solution;
+}
+
+
+/**
+ * Look for a solution to start, and count it as a hit or a miss
+ */
+struct solution* solution_cache_lookup(struct state* start, const int N, double* suboptimality_bound){
+	return lookup(start, N, suboptimality_bound, 1);
+}
+
+
+/**
+ * Look for a solution to start again, after a miss that was already counted
+ */
+struct solution* solution_cache_recheck(struct state* start, const int N, double* suboptimality_bound){
+	return lookup(start, N, suboptimality_bound, 0);
+}
+
+
+/**
+ * Put a copy of a solution into the cache, and onto the end of the store
+ */
+void solution_cache_insert(struct solution* solution, const int N, const double suboptimality_bound){
+	if(cache_initialized == 0){
+		return;
+	}
+
+	//Everything is put together before the shard is locked
+	short* tiles = malloc(sizeof(short) * N * N);
+	int flipped = canonical_solution_tiles(solution->start, N, tiles);
+	u_int64_t hash = hash_canonical_tiles(tiles, N);
+	struct solution_cache_entry* entry = create_entry(tiles, N, hash, solution->moves, solution->num_moves,
+													  suboptimality_bound);
+	if(flipped == 1){
+		for(int i = 0; i < entry->num_moves; i++){
+			entry->moves[i] = flip_solution_move(entry->moves[i]);
+		}
+	}
+
+	//A full or missing store only costs the next server that runs a miss
+	solution_store_append(entry->tiles, N, hash, entry->moves, entry->num_moves, suboptimality_bound);
+
+	add_entry(entry, 0);
+}
+
+
+/**
+ * Add up the counts from every shard
+ */
+void get_solution_cache_statistics(struct solution_cache_statistics* statistics){
+	statistics->hits = 0;
+	statistics->store_hits = 0;
+	statistics->misses = 0;
+	statistics->insertions = 0;
+	statistics->evictions = 0;
+	statistics->entries = 0;
+	statistics->bytes = 0;
+
+	if(cache_initialized == 0){
+		return;
+	}
+
+	for(int i = 0; i < SOLUTION_CACHE_SHARDS; i++){
+		struct solution_cache_shard* shard = &(shards[i]);
+
+		pthread_mutex_lock(&(shard->lock));
+		statistics->hits += shard->hits;
+		statistics->store_hits += shard->store_hits;
+		statistics->misses += shard->misses;
+		statistics->insertions += shard->insertions;
+		statistics->evictions += shard->evictions;
+		statistics->entries += shard->num_entries;
+		statistics->bytes += shard->bytes;
+		pthread_mutex_unlock(&(shard->lock));
+	}
+}
+
+
+/**
+ * Free every shard and everything in it
+ */
+void destroy_solution_cache(void){
+	if(cache_initialized == 0){
+		return;
+	}
+
+	for(int i = 0; i < SOLUTION_CACHE_SHARDS; i++){
+		struct solution_cache_shard* shard = &(shards[i]);
+		struct solution_cache_entry* entry = shard->newest;
+
+		while(entry != NULL){
+			struct solution_cache_entry* older = entry->older;
+			destroy_entry(entry);
+			entry = older;
+		}
+
+		free(shard->buckets);
+		pthread_mutex_destroy(&(shard->lock));
+	}
+
+	cache_initialized = 0;
+}
@@ -0,0 +1,139 @@
+/**
+ * Author: Jack Robbins
+ * This header file defines the solution cache, which every connection thread in the server shares. The same start
+ * configurations come up again and again, especially for the lower complexities, so each solution is kept around
+ * and handed back the next time that its start is asked for, instead of being solved all over again.
+ *
+ * The usual goal is symmetric along its diagonal, so flipping a puzzle over that diagonal and renumbering its tiles
+ * gives another puzzle that is solved by the same moves, flipped the same way. Both of them are stored as whichever
+ * of the two layouts comes first, so one entry answers for both. Anything that isn't in memory is looked for in the
+ * solution store on disk, if it's open. The functions are implemented in solution_cache.c
+ */
+
+#ifndef SOLUTION_CACHE_H
+#define SOLUTION_CACHE_H
+
+//How many separately locked pieces the cache is split into, so that threads rarely wait on each other. The top bits
+//of the hash pick the shard, so this must be a power of 2
+#define SOLUTION_CACHE_SHARD_BITS 4
+#define SOLUTION_CACHE_SHARDS (1 << SOLUTION_CACHE_SHARD_BITS)
+//How much memory the server lets the cache take up, in bytes
+#define SOLUTION_CACHE_DEFAULT_BYTES (64 * 1024 * 1024)
+//How many buckets every shard starts out with, always a power of 2. It doubles whenever it fills up
+#define SOLUTION_CACHE_INITIAL_BUCKETS 64
+
+#include <pthread.h>
+#include "../npuzzle/puzzle/solution.h"
+#include "solution_store.h"
+
+/**
+ * One cached solution. The start that it belongs to is only kept as its canonical tiles, and the moves are the ones
+ * that solve that layout
+ */
+struct solution_cache_entry {
+	int N;
+	//The canonical layout of the tiles, N * N of them
+	short* tiles;
+	u_int64_t hash;
+	char* moves;
+	int num_moves;
+	//How much longer than the shortest solution this one could be, as the solver worked it out
+	double suboptimality_bound;
+	//Everything that this entry takes up, which is what counts against its shard's budget
+	size_t size;
+	//The next entry in the same bucket
+	struct solution_cache_entry* next_in_bucket;
+	//The entries on either side in the shard's least recently used order
+	struct solution_cache_entry* newer;
+	struct solution_cache_entry* older;
+};
+
+
+/**
+ * One piece of the cache, which has its own lock, its own buckets and its own share of the memory budget. Once it
+ * goes over its share, the least recently used entries are thrown out until it fits again
+ */
+struct solution_cache_shard {
+	pthread_mutex_t lock;
+	struct solution_cache_entry** buckets;
+	int num_buckets;
+	int num_entries;
+	//Looked up or added most recently, and the one that is thrown out next
+	struct solution_cache_entry* newest;
+	struct solution_cache_entry* oldest;
+	size_t bytes;
+	size_t max_bytes;
+	long hits;
+	//How many of the misses the solution store had the answer to
+	long store_hits;
+	long misses;
+	long insertions;
+	long evictions;
+};
+
+
+/**
+ * How the cache has done so far, added up across every shard
+ */
+struct solution_cache_statistics {
+	long hits;
+	long store_hits;
+	long misses;
+	long insertions;
+	long evictions;
+	long entries;
+	size_t bytes;
+};
+
+
+/**
+ * Write the canonical layout of state_ptr into tiles, which has room for N * N of them. Returns 1 if that layout is
+ * state_ptr flipped over its diagonal, in which case its moves have to be flipped too, or 0 if it's state_ptr's own
+ */
+int canonical_solution_tiles(struct state* state_ptr, const int N, short* tiles);
+
+/**
+ * The hash of a canonical layout, which is just as good in its top bits as in its bottom bits
+ */
+u_int64_t hash_canonical_tiles(const short* tiles, const int N);
+
+/**
+ * What one of the SOLUTION_MOVE letters becomes once the puzzle is flipped over its diagonal
+ */
+char flip_solution_move(const char move);
+
+/**
+ * Get the cache ready to hold up to max_bytes worth of solutions. This is not thread safe, so it should be called
+ * before the server starts taking connections. Returns 0 on success and -1 on failure
+ */
+int initialize_solution_cache(const size_t max_bytes);
+
+/**
+ * Look for a solution to start that is already in the cache or the store, where the goal is the usual one. If there
+ * is one, a copy of it that starts from start is returned, which the caller frees with destroy_solution, and
+ * suboptimality_bound is filled in. Returns NULL if there isn't one, or the cache was never initialized
+ */
+struct solution* solution_cache_lookup(struct state* start, const int N, double* suboptimality_bound);
+
+/**
+ * The same as solution_cache_lookup, for a start whose miss has already been counted once. Only a hit is counted
+ */
+struct solution* solution_cache_recheck(struct state* start, const int N, double* suboptimality_bound);
+
+/**
+ * Put a copy of a solution to the usual goal into the cache and the store, so that the next lookup of its start or of
+ * its mirror image finds it. The solution itself still belongs to the caller
+ */
+void solution_cache_insert(struct solution* solution, const int N, const double suboptimality_bound);
+
+/**
+ * Fill in how many lookups have hit and missed so far, along with everything else that the cache keeps count of
+ */
+void get_solution_cache_statistics(struct solution_cache_statistics* statistics);
+
+/**
+ * Free every entry and everything else that the cache holds onto
+ */
+void destroy_solution_cache(void);
+
+#endif /* SOLUTION_CACHE_H */
@@ -0,0 +1,292 @@
+/**
+ * Author: Jack Robbins
+ * This file implements the solution store. The whole file is mapped in once, with room for it to grow, and the file
+ * itself is made bigger underneath the mapping as records are added. A record is written in full and the header
+ * says so before its index slot is filled in, so a lookup never has to take a lock, and a server that stops halfway
+ * through adding one leaves at worst a record that nothing points to.
+ *
+ * Opening the store only checks the header. Every record is checked as it's looked up instead, against the layout
+ * that it was looked up for, and the cache plays its moves out before it trusts them, so a damaged file can cost a
+ * miss but never a wrong answer
+ */
+
+#include "solution_store.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//The one store that the process keeps open
+static struct solution_store store;
+//Lookups miss and appends fail until the store is open
+static int store_open = 0;
+
+
+/**
+ * Where the records begin, right after an index with 2^index_bits slots
+ */
+static size_t records_offset(const u_int32_t index_bits){
+	return sizeof(struct solution_store_header) + ((size_t)1 << index_bits) * sizeof(struct solution_store_slot);
+}
+
+
+/**
+ * How much room a record takes up, padded out so that the next one stays 8 byte aligned
+ */
+static u_int64_t record_size(const u_int32_t N, const u_int32_t num_moves){
+	u_int64_t size = sizeof(struct solution_store_record) + sizeof(short) * (u_int64_t)N * N + num_moves;
+	return (size + 7) & ~(u_int64_t)7;
+}
+
+
+/**
+ * The hash that a layout is filed under. A hash of 0 marks an empty slot, so it's never used
+ */
+static u_int64_t store_key(const u_int64_t hash){
+	return hash | 1;
+}
+
+
+/**
+ * The record at offset, if it's all there and it's the one for this layout. Returns NULL otherwise
+ */
+static const struct solution_store_record* matching_record(const u_int64_t offset, const u_int64_t key, const short* tiles,
+														   const int N){
+	u_int64_t used = __atomic_load_n(&(store.header->used), __ATOMIC_ACQUIRE);
+
+	//Anything that points outside of what has been written, or into the middle of a record, is damaged
+	//Every check subtracts from used instead of adding to offset, so a damaged offset can't wrap around
+	if(offset < records_offset(store.header->index_bits) || offset % 8 != 0 || offset > used
+	   || used - offset < sizeof(struct solution_store_record)){
+		return NULL;
+	}
+
+	const struct solution_store_record* record = (const struct solution_store_record*)((char*)store.header + offset);
+
+	//A damaged count of moves could be anything at all, so it's checked against what's left before it's added up
+	if(record->hash != key || record->N != (u_int32_t)N || record->num_moves > used - offset
+	   || record_size(record->N, record->num_moves) > used - offset){
+		return NULL;
+	}
+
+	if(memcmp(record + 1, tiles, sizeof(short) * N * N) != 0){
+		return NULL;
+	}
+
+	return record;
+}
+
+
+/**
+ * Map the store in, or set up a new one
+ */
+int open_solution_store(const char* filename){
+	//Only ever open it once
+	if(store_open == 1){
+		return 0;
+	}
+
+	int fd = open(filename, O_RDWR | O_CREAT, 0644);
+	if(fd < 0){
+		return -1;
+	}
+
+	//Two servers adding onto the same file would tear each other's records apart
+	struct stat file_stats;
+	if(flock(fd, LOCK_EX | LOCK_NB) != 0 || fstat(fd, &file_stats) != 0 || (size_t)file_stats.st_size > SOLUTION_STORE_MAX_BYTES){
+		close(fd);
+		return -1;
+	}
+
+	//Set aside room for the file to grow into, only the pages that are touched ever take up memory
+	void* map = mmap(NULL, SOLUTION_STORE_MAX_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if(map == MAP_FAILED){
+		close(fd);
+		return -1;
+	}
+
+	struct solution_store_header* header = map;
+	size_t file_size = file_stats.st_size;
+
+	if(file_size == 0){
+		//A brand new store, the index is all holes in the file until something is put in it
+		file_size = records_offset(SOLUTION_STORE_INDEX_BITS);
+		if(ftruncate(fd, file_size) != 0){
+			munmap(map, SOLUTION_STORE_MAX_BYTES);
+			close(fd);
+			return -1;
+		}
+
+		memcpy(header->magic, "NPZSS", 5);
+		header->version = SOLUTION_STORE_VERSION;
+		header->index_bits = SOLUTION_STORE_INDEX_BITS;
+		header->used = file_size;
+		header->num_records = 0;
+	} else if(file_size < sizeof(struct solution_store_header) || memcmp(header->magic, "NPZSS", 5) != 0
+			  || header->version != SOLUTION_STORE_VERSION || header->index_bits < 8 || header->index_bits > 26
+			  || file_size < records_offset(header->index_bits) || header->used < records_offset(header->index_bits)
+			  || header->used > file_size){
+		//This isn't a store that we know how to read, so leave it alone rather than writing over it
+		munmap(map, SOLUTION_STORE_MAX_BYTES);
+		close(fd);
+		return -1;
+	}
+
+	store.fd = fd;
+	store.header = header;
+	store.index = (struct solution_store_slot*)(header + 1);
+	store.index_mask = ((u_int64_t)1 << header->index_bits) - 1;
+	store.file_size = file_size;
+	pthread_mutex_init(&(store.append_lock), NULL);
+
+	store_open = 1;
+	return 0;
+}
+
+
+/**
+ * How many solutions the store holds
+ */
+long solution_store_size(void){
+	if(store_open == 0){
+		return 0;
+	}
+
+	return __atomic_load_n(&(store.header->num_records), __ATOMIC_RELAXED);
+}
+
+
+/**
+ * Follow the index from where the hash lands until either the layout or an empty slot turns up
+ */
+int solution_store_find(const short* tiles, const int N, const u_int64_t hash, char** moves, int* num_moves,
+						double* suboptimality_bound){
+	if(store_open == 0){
+		return 0;
+	}
+
+	u_int64_t key = store_key(hash);
+	u_int64_t slot = key & store.index_mask;
+
+	for(u_int64_t probes = 0; probes <= store.index_mask; probes++){
+		u_int64_t slot_hash = __atomic_load_n(&(store.index[slot].hash), __ATOMIC_ACQUIRE);
+
+		//Nothing has ever been filed this far along
+		if(slot_hash == 0){
+			return 0;
+		}
+
+		if(slot_hash == key){
+			const struct solution_store_record* record = matching_record(store.index[slot].offset, key, tiles, N);
+
+			if(record != NULL){
+				const char* stored_moves = (const char*)(record + 1) + sizeof(short) * N * N;
+
+				*num_moves = record->num_moves;
+				*moves = malloc(record->num_moves > 0 ? record->num_moves : 1);
+				memcpy(*moves, stored_moves, record->num_moves);
+				*suboptimality_bound = record->suboptimality_bound;
+
+				return 1;
+			}
+		}
+
+		slot = (slot + 1) & store.index_mask;
+	}
+
+	return 0;
+}
+
+
+/**
+ * Write the record onto the end of the file, then file it in the index
+ */
+int solution_store_append(const short* tiles, const int N, const u_int64_t hash, const char* moves, const int num_moves,
+						  const double suboptimality_bound){
+	if(store_open == 0){
+		return -1;
+	}
+
+	u_int64_t key = store_key(hash);
+	u_int64_t size = record_size(N, num_moves);
+
+	pthread_mutex_lock(&(store.append_lock));
+
+	//Past 3/4 full, the runs of filled slots that a lookup has to walk past get too long
+	if(store.header->num_records + 1 > (store.index_mask + 1) / 4 * 3){
+		pthread_mutex_unlock(&(store.append_lock));
+		return -1;
+	}
+
+	//Find the first empty slot, unless this layout already has one
+	u_int64_t slot = key & store.index_mask;
+	while(store.index[slot].hash != 0){
+		if(store.index[slot].hash == key && matching_record(store.index[slot].offset, key, tiles, N) != NULL){
+			pthread_mutex_unlock(&(store.append_lock));
+			return 0;
+		}
+
+		slot = (slot + 1) & store.index_mask;
+	}
+
+	u_int64_t offset = store.header->used;
+	if(offset + size > SOLUTION_STORE_MAX_BYTES){
+		pthread_mutex_unlock(&(store.append_lock));
+		return -1;
+	}
+
+	//Make the file bigger underneath the mapping, a good chunk at a time
+	if(offset + size > store.file_size){
+		size_t file_size = (offset + size + SOLUTION_STORE_GROW_BYTES - 1) / SOLUTION_STORE_GROW_BYTES * SOLUTION_STORE_GROW_BYTES;
+		if(file_size > SOLUTION_STORE_MAX_BYTES){
+			file_size = SOLUTION_STORE_MAX_BYTES;
+		}
+
+		if(ftruncate(store.fd, file_size) != 0){
+			pthread_mutex_unlock(&(store.append_lock));
+			return -1;
+		}
+
+		store.file_size = file_size;
+	}
+
+	struct solution_store_record* record = (struct solution_store_record*)((char*)store.header + offset);
+	record->hash = key;
+	record->N = N;
+	record->num_moves = num_moves;
+	record->suboptimality_bound = suboptimality_bound;
+	memcpy(record + 1, tiles, sizeof(short) * N * N);
+	memcpy((char*)(record + 1) + sizeof(short) * N * N, moves, num_moves);
+
+	//The record is all there before the header says so, and the header says so before the index points to it
+	__atomic_store_n(&(store.header->used), offset + size, __ATOMIC_RELEASE);
+	__atomic_add_fetch(&(store.header->num_records), 1, __ATOMIC_RELAXED);
+	store.index[slot].offset = offset;
+	__atomic_store_n(&(store.index[slot].hash), key, __ATOMIC_RELEASE);
+
+	pthread_mutex_unlock(&(store.append_lock));
+
+	return 0;
+}
+
+
+/**
+ * Write everything out to the file and let it go
+ */
+void close_solution_store(void){
+	if(store_open == 0){
+		return;
+	}
+
+	store_open = 0;
+
+	msync(store.header, store.file_size, MS_SYNC);
+	munmap(store.header, SOLUTION_STORE_MAX_BYTES);
+	//Closing the file lets go of the lock on it too
+	close(store.fd);
+	pthread_mutex_destroy(&(store.append_lock));
+}
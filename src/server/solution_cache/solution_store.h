@@ -0,0 +1,113 @@
+/**
+ * Author: Jack Robbins
+ * This header file defines the solution store, which keeps every solution that the server finds in a file on disk,
+ * so that a restarted server can answer the puzzles that it has already solved straight away. The solution cache
+ * looks in the store whenever it misses, and adds everything that it's given to the store as well.
+ *
+ * The file is only ever mapped into memory, never read through. An index of fixed size comes right after the header,
+ * and the solutions themselves are only ever added onto the end after that, so opening the store takes the same time
+ * no matter how many solutions it holds. The functions are implemented in solution_store.c
+ */
+
+#ifndef SOLUTION_STORE_H
+#define SOLUTION_STORE_H
+
+//The file that the server keeps its solutions in
+#define SOLUTION_STORE_FILE "solution_store.bin"
+//Bump this whenever the file layout changes
+#define SOLUTION_STORE_VERSION 1
+//How many bits of the hash pick an index slot. Every slot takes 16 bytes, and the index never fills up past 3/4 of them
+#define SOLUTION_STORE_INDEX_BITS 20
+//The most that the file may ever grow to. This much address space is set aside when the store is opened, but only
+//the part of it that has been written to ever takes up any memory
+#define SOLUTION_STORE_MAX_BYTES ((size_t)1 << 30)
+//The file grows by this much at a time
+#define SOLUTION_STORE_GROW_BYTES ((size_t)1 << 20)
+
+#include <pthread.h>
+#include <sys/types.h>
+
+/**
+ * The header at the very start of the store. The index comes right after it, and then the records
+ */
+struct solution_store_header {
+	//Always "NPZSS" followed by three null characters
+	char magic[8];
+	u_int32_t version;
+	u_int32_t index_bits;
+	//Where the next record goes, from the start of the file. Everything before it has been written in full
+	u_int64_t used;
+	u_int64_t num_records;
+};
+
+
+/**
+ * One slot of the index. An empty slot has a hash of 0, and the hash is always the last thing written into a slot,
+ * so a reader that sees it can trust the offset next to it
+ */
+struct solution_store_slot {
+	u_int64_t hash;
+	u_int64_t offset;
+};
+
+
+/**
+ * One solution in the store. The canonical tiles come right after it, then the moves, padded out to 8 bytes
+ */
+struct solution_store_record {
+	u_int64_t hash;
+	u_int32_t N;
+	u_int32_t num_moves;
+	double suboptimality_bound;
+};
+
+
+/**
+ * Everything that the open store keeps track of
+ */
+struct solution_store {
+	int fd;
+	//The start of the mapping, which is the header
+	struct solution_store_header* header;
+	struct solution_store_slot* index;
+	u_int64_t index_mask;
+	//How big the file is right now, which can be less than the mapping
+	size_t file_size;
+	//Only one thread may add onto the end at a time. Lookups never take it
+	pthread_mutex_t append_lock;
+};
+
+
+/**
+ * Map the store in from filename, or make a new one if there isn't one there. Nothing but the header is looked at.
+ * This is not thread safe, so it should be called before the server starts taking connections. Returns 0 on success
+ * and -1 if the store can't be used, in which case every lookup just misses
+ */
+int open_solution_store(const char* filename);
+
+/**
+ * How many solutions the store holds
+ */
+long solution_store_size(void);
+
+/**
+ * Look for the solution to a canonical layout, which hashes to hash. If it's there, moves is set to a copy of its
+ * moves that the caller frees, num_moves and suboptimality_bound are filled in, and 1 is returned. Returns 0 otherwise.
+ * Only the layout is checked, so the moves have to be played out before they're trusted
+ */
+int solution_store_find(const short* tiles, const int N, const u_int64_t hash, char** moves, int* num_moves,
+						double* suboptimality_bound);
+
+/**
+ * Add the solution to a canonical layout onto the end of the store, unless it's already there. Returns 0 on
+ * success, or -1 if the store isn't open or is full
+ */
+int solution_store_append(const short* tiles, const int N, const u_int64_t hash, const char* moves, const int num_moves,
+						  const double suboptimality_bound);
+
+/**
+ * Write everything out and unmap the store
+ */
+void close_solution_store(void);
+
+#endif /* SOLUTION_STORE_H */
@@ -0,0 +1,162 @@
+/**
+ * Author: Jack Robbins
+ * This file implements the solve registry. One lock covers every bucket, since it's only ever held long enough to
+ * find, add or take out a solve, and never while anything is being solved. Every solve has a condition of its own,
+ * so the threads waiting on one are only ever woken up by that one.
+ *
+ * A solve is taken out of the registry as soon as it's finished, but it stays alive until the last thread holding a
+ * reference to it lets go. The thread that solved it puts its solution into the cache first. A request that missed
+ * the cache just before that can still find the registry empty and become a leader itself, so a leader always looks
+ * in the cache once more before it solves anything
+ */
+
+#include "solve_registry.h"
+
+//Every solve in flight, by the hash of its canonical layout
+static struct solve_flight* registry[SOLVE_REGISTRY_BUCKETS];
+//Held to look through, add to or take out of the registry, and to change a reference count
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+/**
+ * Let go of a solve, and free it if nothing else is holding onto it. The registry must be locked
+ */
+static void release_flight(struct solve_flight* flight){
+	(flight->references)--;
+
+	if(flight->references > 0){
+		return;
+	}
+
+	pthread_cond_destroy(&(flight->finished));
+	free(flight->tiles);
+	free(flight->moves);
+	free(flight);
+}
+
+
+/**
+ * Find the solve in flight for start, or add a new one that this thread leads
+ */
+struct solve_flight* begin_solve_flight(struct state* start, const int N, int* leader){
+	short* tiles = malloc(sizeof(short) * N * N);
+	int flipped = canonical_solution_tiles(start, N, tiles);
+	u_int64_t hash = hash_canonical_tiles(tiles, N);
+	int bucket = hash & (SOLVE_REGISTRY_BUCKETS - 1);
+
+	pthread_mutex_lock(&registry_lock);
+
+	for(struct solve_flight* flight = registry[bucket]; flight != NULL; flight = flight->next){
+		if(flight->hash == hash && flight->N == N && memcmp(flight->tiles, tiles, sizeof(short) * N * N) == 0){
+			//Somebody else is already on it
+			(flight->references)++;
+			pthread_mutex_unlock(&registry_lock);
+
+			free(tiles);
+			*leader = 0;
+			return flight;
+		}
+	}
+
+	struct solve_flight* flight = malloc(sizeof(struct solve_flight));
+	flight->N = N;
+	flight->tiles = tiles;
+	flight->hash = hash;
+	flight->leader_flipped = flipped;
+	flight->done = 0;
+	flight->moves = NULL;
+	flight->num_moves = 0;
+	flight->suboptimality_bound = 1.0;
+	flight->references = 1;
+	pthread_cond_init(&(flight->finished), NULL);
+	flight->next = registry[bucket];
+	registry[bucket] = flight;
+
+	pthread_mutex_unlock(&registry_lock);
+
+	*leader = 1;
+	return flight;
+}
+
+
+/**
+ * Keep the canonical moves of the solution, take the solve out of the registry and wake up everyone waiting on it
+ */
+void finish_solve_flight(struct solve_flight* flight, struct solution* solution, const double suboptimality_bound){
+	//Everything is copied before the registry is locked
+	char* moves = NULL;
+	int num_moves = 0;
+
+	if(solution != NULL){
+		num_moves = solution->num_moves;
+		moves = malloc(num_moves > 0 ? num_moves : 1);
+		for(int i = 0; i < num_moves; i++){
+			moves[i] = flight->leader_flipped == 1 ? flip_solution_move(solution->moves[i]) : solution->moves[i];
+		}
+	}
+
+	pthread_mutex_lock(&registry_lock);
+
+	//Nobody new can join it from here on out
+	struct solve_flight** cursor = &(registry[flight->hash & (SOLVE_REGISTRY_BUCKETS - 1)]);
+	while(*cursor != flight){
+		cursor = &((*cursor)->next);
+	}
+	*cursor = flight->next;
+
+	flight->moves = moves;
+	flight->num_moves = num_moves;
+	flight->suboptimality_bound = suboptimality_bound;
+	flight->done = 1;
+	pthread_cond_broadcast(&(flight->finished));
+
+	release_flight(flight);
+
+	pthread_mutex_unlock(&registry_lock);
+}
+
+
+/**
+ * Wait for the solve to finish, and make a solution for start out of its moves
+ */
+struct solution* wait_for_solve_flight(struct solve_flight* flight, struct state* start, const int N,
+									   double* suboptimality_bound){
+	//Only the layout's orientation matters here, the tiles themselves are already known
+	short* tiles = malloc(sizeof(short) * N * N);
+	int flipped = canonical_solution_tiles(start, N, tiles);
+	free(tiles);
+
+	char* moves = NULL;
+	int num_moves = 0;
+
+	pthread_mutex_lock(&registry_lock);
+
+	while(flight->done == 0){
+		pthread_cond_wait(&(flight->finished), &registry_lock);
+	}
+
+	//The moves belong to the solve, so every thread takes a copy of its own before letting go
+	if(flight->moves != NULL){
+		num_moves = flight->num_moves;
+		moves = malloc(num_moves > 0 ? num_moves : 1);
+		memcpy(moves, flight->moves, num_moves);
+		*suboptimality_bound = flight->suboptimality_bound;
+	}
+
+	release_flight(flight);
+
+	pthread_mutex_unlock(&registry_lock);
+
+	if(moves == NULL){
+		return NULL;
+	}
+
+	//The moves solve the canonical layout, so they have to be flipped back if start is the other one
+	if(flipped == 1){
+		for(int i = 0; i < num_moves; i++){
+			moves[i] = flip_solution_move(moves[i]);
+		}
+	}
+
+	return initialize_solution_from_moves(start, moves, num_moves, N);
+}
@@ -0,0 +1,67 @@
+/**
+ * Author: Jack Robbins
+ * This header file defines the solve registry, which keeps track of every puzzle that the server is in the middle
+ * of solving. When a request comes in for a puzzle that another connection thread is already solving, or for its
+ * mirror image, it waits for that solve to finish and shares its result, instead of running the same solve again.
+ * The functions are implemented in solve_registry.c
+ */
+
+#ifndef SOLVE_REGISTRY_H
+#define SOLVE_REGISTRY_H
+
+//How many buckets the registry spreads the solves in flight over, always a power of 2. There are never more of them
+//than there are connection threads, so this never has to grow
+#define SOLVE_REGISTRY_BUCKETS 64
+
+#include <pthread.h>
+#include "solution_cache.h"
+
+/**
+ * One solve in flight. The thread that started it is the only one that ever solves it, and every other thread that
+ * asks for the same canonical layout holds a reference to it until it has made its own copy of the result. The last
+ * thread to let go of it frees it
+ */
+struct solve_flight {
+	int N;
+	//The canonical layout that is being solved, N * N of them
+	short* tiles;
+	u_int64_t hash;
+	//Whether the thread that is solving it has the flipped layout
+	int leader_flipped;
+	//Set once the solve is over, along with everything below it
+	int done;
+	//The moves that solve the canonical layout, or NULL if there was no solution
+	char* moves;
+	int num_moves;
+	double suboptimality_bound;
+	//How many threads are still holding onto this, counting the one that is solving it
+	int references;
+	//Signaled once the solve is over
+	pthread_cond_t finished;
+	//The next solve in flight in the same bucket
+	struct solve_flight* next;
+};
+
+
+/**
+ * Join the solve in flight for start, or start a new one if there isn't one. If leader comes back as 1, this thread
+ * has to look in the cache again with solution_cache_recheck, solve start itself if it's still not there, and then
+ * call finish_solve_flight either way. If it comes back as 0, another thread is already solving it, and this one
+ * should call wait_for_solve_flight
+ */
+struct solve_flight* begin_solve_flight(struct state* start, const int N, int* leader);
+
+/**
+ * Hand the result of a solve over to every thread that is waiting on it, and let go of it. The solution can be
+ * NULL if there isn't one, and it still belongs to the caller either way
+ */
+void finish_solve_flight(struct solve_flight* flight, struct solution* solution, const double suboptimality_bound);
+
+/**
+ * Wait for the solve that start joined to finish, and let go of it. Returns a solution of start's own, which the
+ * caller frees with destroy_solution, with suboptimality_bound filled in, or NULL if there is no solution
+ */
+struct solution* wait_for_solve_flight(struct solve_flight* flight, struct state* start, const int N,
+									   double* suboptimality_bound);
+
+#endif /* SOLVE_REGISTRY_H */
@@ -6,12 +6,35 @@
 //Hook into our and the npuzzle
 #include "server/npuzzle/solver/solve.h"
 #include "server/npuzzle/puzzle/puzzle.h"
+#include "server/npuzzle/puzzle/random_generator.h"
 #include "server/remote_server/server.h"
+#include "server/npuzzle/heuristic/pattern_database.h"
+#include "server/npuzzle/heuristic/walking_distance.h"
+#include "server/npuzzle/solver/solve_table.h"
 #include <stdio.h>
 #include <sys/socket.h>
 #include <unistd.h>
 
 
+/**
+ * Map in the 4x4 pattern database if it has been built, and get the walking distance tables ready. Every solve in
+ * this process shares the one copy of each, and if the pattern database isn't there the solver just uses walking
+ * distance instead. A walking distance table that has to be built is only written out to its file if write_cache is
+ * 1, so that only the server leaves files behind for the next run
+ */
+static void load_heuristics(const int write_cache){
+	if(load_pattern_database(PATTERN_DATABASE_FILE) == 0){
+		printf("Loaded the 4x4 pattern database from %s\n", PATTERN_DATABASE_FILE);
+	} else {
+		printf("No pattern database found, run with -p to build one. Using walking distance for 4x4\n");
+	}
+
+	for(int N = WALKING_DISTANCE_MIN_N; N <= WALKING_DISTANCE_MAX_N; N++){
+		initialize_walking_distance(N, write_cache);
+	}
+}
+
+
 /**
  * This function essentially duplicates the functionality 
  * of the program that inspired this one. It is purely on the 
@@ -37,26 +60,479 @@ int run_command_line(){
 	int complexity;
 	printf("Enter the complexity of the initial configuration: ");
 	scanf("%d", &complexity);
+
+	//Grab the pattern database if we have it
+	load_heuristics(0);
  
-	//Generate the starting and goal configuration
-	struct state* initial = generate_start_config(complexity, N);
+	//Generate the starting and goal configuration. The seed is shown so that the same puzzle can be benchmarked later
+	u_int64_t seed = random_seed();
+	printf("Using seed %llu\n", (unsigned long long)seed);
+	struct state* initial = generate_start_config(complexity, N, seed);
 	struct state* goal = initialize_goal(N);
 
+	//Use whatever options are best for this N
+	struct solver_options options = default_solver_options(N);
+
 	//Simply make a call to solve and let it go from there
-	solve(N, initial, goal, 1);
+	solve(N, initial, goal, 1, &options);
+	return 0;
+}
+
+
+/**
+ * Make a standalone copy of a start state, since solve takes ownership of the one that it's given
+ */
+static struct state* duplicate_start_state(struct state* start_state, const int N){
+	struct state* copy = (struct state*)malloc(sizeof(struct state));
+	initialize_state(copy, N);
+	copy_state(start_state, copy, N);
+
+	//copy_state treats the copy as a successor, so undo that
+	copy->current_travel = 0;
+	copy->predecessor = NULL;
+	return copy;
+}
+
+
+/**
+ * One way of running the solver that the benchmark compares
+ */
+struct benchmark_configuration {
+	const char* name;
+	solver_engine engine;
+	expansion_mode expansion;
+};
+
+
+/**
+ * Benchmark the solver by running the same puzzles through every engine, and A* through every expansion mode,
+ * and reporting how much work each one did. Like the command line mode, no server functionality is used
+ */
+int run_benchmark(){
+	//The configurations that we'll compare
+	const struct benchmark_configuration configurations[] = {
+		{"A* thread per move", SOLVER_ENGINE_ASTAR, EXPANSION_THREAD_PER_MOVE},
+		{"A* expansion pool", SOLVER_ENGINE_ASTAR, EXPANSION_POOL},
+		{"A* inline", SOLVER_ENGINE_ASTAR, EXPANSION_INLINE},
+		{"IDA*", SOLVER_ENGINE_IDA, EXPANSION_INLINE},
+		{"HDA*", SOLVER_ENGINE_HDA, EXPANSION_INLINE},
+		{"Bidirectional MM", SOLVER_ENGINE_BIDIRECTIONAL, EXPANSION_INLINE},
+		{"Anytime ARA*", SOLVER_ENGINE_ANYTIME, EXPANSION_INLINE},
+		{"Partial expansion A*", SOLVER_ENGINE_PARTIAL_EXPANSION, EXPANSION_INLINE},
+		{"Reduction", SOLVER_ENGINE_REDUCTION, EXPANSION_INLINE},
+		{"Distance table", SOLVER_ENGINE_TABLE, EXPANSION_INLINE}
+	};
+	const int num_configurations = sizeof(configurations) / sizeof(struct benchmark_configuration);
+
+	printf("\n\n===========================================================================\n");
+	printf("N Puzzle Solver Benchmark\n");
+	printf("===========================================================================\n");
+	printf("Using the %s tile comparison kernel\n", simd_kernel_name());
+
+	//Grab everything that we need from the user
+	int N, complexity, num_puzzles;
+	printf("Enter the dimension N: ");
+	scanf("%d", &N);
+
+	//Input validation
+	if(N < 3){ 
+		printf("Error: N-Puzzle dimension must be 3x3 or higher\n");
+		exit(1);
+	}
+
+	printf("Enter the complexity of the initial configuration: ");
+	scanf("%d", &complexity);
+	printf("Enter the number of puzzles to solve: ");
+	scanf("%d", &num_puzzles);
+	//Every puzzle after the first uses the next seed up, so the same answers always give the same puzzles
+	unsigned long long first_seed;
+	printf("Enter the seed of the first puzzle: ");
+	scanf("%llu", &first_seed);
+
+	struct state* goal = initialize_goal(N);
+
+	//Grab the pattern database if we have it
+	load_heuristics(0);
+
+	//Running totals for every configuration
+	long expanded[num_configurations];
+	long path_length[num_configurations];
+	double wall_time[num_configurations];
+	memset(expanded, 0, sizeof(expanded));
+	memset(path_length, 0, sizeof(path_length));
+	memset(wall_time, 0, sizeof(wall_time));
+
+	for(int i = 0; i < num_puzzles; i++){
+		struct state* start = generate_start_config(complexity, N, first_seed + i);
+
+		//Solve the exact same puzzle with every configuration
+		for(int c = 0; c < num_configurations; c++){
+			struct solver_options options = default_solver_options(N);
+			options.engine = configurations[c].engine;
+			options.expansion = configurations[c].expansion;
+
+			struct solution* solution = solve(N, duplicate_start_state(start, N), goal, 0, &options);
+
+			if(solution != NULL){
+				path_length[c] += solution->num_moves;
+				destroy_solution(solution);
+			}
+
+			expanded[c] += options.statistics.expanded;
+			wall_time[c] += options.statistics.wall_time;
+		}
+
+		destroy_state(start, N);
+		free(start);
+	}
+
+	//Display the results. Every configuration should find paths of the same total length, except for anytime ARA*
+	//if it ran out of time before proving its solution optimal, and for reduction, which never looks for the shortest
+	printf("\n%-20s %12s %12s %14s %20s\n", "Configuration", "Moves", "Expanded", "Wall time(s)", "Expansions/second");
+	for(int c = 0; c < num_configurations; c++){
+		printf("%-20s %12ld %12ld %14.4f %20.0f\n", configurations[c].name, path_length[c], expanded[c], wall_time[c], expanded[c] / wall_time[c]);
+	}
+
+	destroy_state(goal, N);
+	free(goal);
 	return 0;
 }
 
 
+/**
+ * One way of running the solver that the verification has to agree with the reference on
+ */
+struct verification_configuration {
+	const char* name;
+	solver_engine engine;
+	expansion_mode expansion;
+	fringe_type fringe;
+	move_pruning_type pruning;
+};
+
+
+/**
+ * The puzzles that are verified, always the same ones so that a failure can be run again
+ */
+struct verification_puzzles {
+	int N;
+	int complexity;
+	int num_puzzles;
+	u_int64_t first_seed;
+};
+
+
+/**
+ * Make the mirror image of a start state, flipped over its diagonal with its tiles renumbered, which the solution
+ * cache has to answer from the same entry as the state itself
+ */
+static struct state* mirror_start_state(struct state* start_state, const int N){
+	struct state* mirror = duplicate_start_state(start_state, N);
+
+	for(int row = 0; row < N; row++){
+		for(int column = 0; column < N; column++){
+			short tile = get_tile(start_state, row * N + column, N);
+			//The tile that belongs at the flipped spot of this tile's goal, the blank stays the blank
+			short flipped = tile == 0 ? 0 : ((tile - 1) % N) * N + (tile - 1) / N + 1;
+			set_tile(mirror, column * N + row, flipped, N);
+		}
+	}
+
+	mirror->zero_row = start_state->zero_column;
+	mirror->zero_column = start_state->zero_row;
+	mirror->hash = hash_state(mirror, N);
+	return mirror;
+}
+
+
+/**
+ * Check a solution that came back from a lookup. Returns 1 if it's there, solves start and is as long as expected
+ */
+static int check_cached_solution(struct solution* solution, struct state* goal, const int N, const int num_moves){
+	int passed = solution != NULL && verify_solution(solution, goal, N) == 1 && solution->num_moves == num_moves;
+
+	if(solution != NULL){
+		destroy_solution(solution);
+	}
+
+	return passed;
+}
+
+
+/**
+ * Look up every start and its mirror image, and count how many of them don't come back right. Every start must already
+ * have been solved, in num_moves moves
+ */
+static int verify_lookups(struct state** starts, const int* num_moves, const int num_puzzles, struct state* goal, const int N){
+	int failures = 0;
+
+	for(int i = 0; i < num_puzzles; i++){
+		double suboptimality_bound;
+		struct state* mirror = mirror_start_state(starts[i], N);
+
+		if(check_cached_solution(solution_cache_lookup(starts[i], N, &suboptimality_bound), goal, N, num_moves[i]) == 0){
+			printf("FAILED: %dx%d puzzle %d was not looked up correctly\n", N, N, i);
+			failures++;
+		}
+
+		if(check_cached_solution(solution_cache_lookup(mirror, N, &suboptimality_bound), goal, N, num_moves[i]) == 0){
+			printf("FAILED: The mirror image of %dx%d puzzle %d was not looked up correctly\n", N, N, i);
+			failures++;
+		}
+
+		destroy_state(mirror, N);
+		free(mirror);
+	}
+
+	return failures;
+}
+
+
+/**
+ * Solve a fixed set of puzzles with every engine, heuristic, fringe, pruning and expansion mode, and make sure that
+ * every one of them finds a solution that works, and that every optimal one is as short as A*'s. Then put the
+ * solutions through the solution cache and the solution store and make sure that they come back out right. Compile
+ * with -DHEURISTIC_CROSS_CHECK to have every incremental heuristic checked along the way too. Returns the number of
+ * failures, so 0 means that everything passed
+ */
+int run_verification(){
+	//A* with the plainest of everything is the reference that every other configuration is held to
+	const struct verification_configuration configurations[] = {
+		{"A* heap", SOLVER_ENGINE_ASTAR, EXPANSION_INLINE, FRINGE_HEAP, MOVE_PRUNING_INVERSE},
+		{"A* bucket", SOLVER_ENGINE_ASTAR, EXPANSION_INLINE, FRINGE_BUCKET, MOVE_PRUNING_INVERSE},
+		{"A* machine pruning", SOLVER_ENGINE_ASTAR, EXPANSION_INLINE, FRINGE_BUCKET, MOVE_PRUNING_MACHINE},
+		{"A* thread per move", SOLVER_ENGINE_ASTAR, EXPANSION_THREAD_PER_MOVE, FRINGE_BUCKET, MOVE_PRUNING_MACHINE},
+		{"A* expansion pool", SOLVER_ENGINE_ASTAR, EXPANSION_POOL, FRINGE_BUCKET, MOVE_PRUNING_MACHINE},
+		{"IDA*", SOLVER_ENGINE_IDA, EXPANSION_INLINE, FRINGE_BUCKET, MOVE_PRUNING_MACHINE},
+		{"HDA*", SOLVER_ENGINE_HDA, EXPANSION_INLINE, FRINGE_BUCKET, MOVE_PRUNING_MACHINE},
+		{"Bidirectional MM", SOLVER_ENGINE_BIDIRECTIONAL, EXPANSION_INLINE, FRINGE_BUCKET, MOVE_PRUNING_MACHINE},
+		{"Anytime ARA*", SOLVER_ENGINE_ANYTIME, EXPANSION_INLINE, FRINGE_BUCKET, MOVE_PRUNING_MACHINE},
+		{"Partial expansion A*", SOLVER_ENGINE_PARTIAL_EXPANSION, EXPANSION_INLINE, FRINGE_BUCKET, MOVE_PRUNING_MACHINE},
+		{"Reduction", SOLVER_ENGINE_REDUCTION, EXPANSION_INLINE, FRINGE_HEAP, MOVE_PRUNING_MACHINE},
+		{"Distance table", SOLVER_ENGINE_TABLE, EXPANSION_INLINE, FRINGE_BUCKET, MOVE_PRUNING_MACHINE}
+	};
+	const int num_configurations = sizeof(configurations) / sizeof(struct verification_configuration);
+	const heuristic_type heuristics[] = {HEURISTIC_LINEAR_CONFLICT, HEURISTIC_WALKING_DISTANCE, HEURISTIC_PATTERN_DATABASE};
+	const char* heuristic_names[] = {"linear conflict", "walking distance", "pattern database"};
+	const int num_heuristics = sizeof(heuristics) / sizeof(heuristic_type);
+	//Small enough that even IDA* and MM get through the 5x5 ones quickly
+	const struct verification_puzzles puzzle_sets[] = {
+		{3, 40, 5, 1},
+		{4, 50, 5, 1},
+		{5, 30, 3, 1}
+	};
+	const int num_puzzle_sets = sizeof(puzzle_sets) / sizeof(struct verification_puzzles);
+	//Left behind in the working directory if the verification is killed partway through
+	const char* store_file = "verification_store.bin";
+
+	printf("\n\n===========================================================================\n");
+	printf("N Puzzle Solver Verification\n");
+	printf("===========================================================================\n");
+	printf("Using the %s tile comparison kernel\n", simd_kernel_name());
+#ifdef HEURISTIC_CROSS_CHECK
+	printf("Every incremental heuristic is checked against the full one\n");
+#else
+	printf("Built without -DHEURISTIC_CROSS_CHECK, so incremental heuristics are not checked\n");
+#endif
+
+	//Only the server writes out the tables that it builds
+	load_heuristics(0);
+
+	//Start from an empty store, so that everything that the second lookups find was written by this run
+	unlink(store_file);
+	if(initialize_solution_cache(SOLUTION_CACHE_DEFAULT_BYTES) != 0 || open_solution_store(store_file) != 0){
+		printf("FAILED: Could not set up the solution cache and the solution store %s\n", store_file);
+		return 1;
+	}
+
+	int failures = 0;
+	long solves = 0;
+
+	for(int p = 0; p < num_puzzle_sets; p++){
+		const int N = puzzle_sets[p].N;
+		const int num_puzzles = puzzle_sets[p].num_puzzles;
+		struct state* goal = initialize_goal(N);
+		struct state* starts[num_puzzles];
+		int reference_moves[num_puzzles];
+
+		printf("Verifying %d %dx%d puzzles of complexity %d...\n", num_puzzles, N, N, puzzle_sets[p].complexity);
+
+		for(int i = 0; i < num_puzzles; i++){
+			starts[i] = generate_start_config(puzzle_sets[p].complexity, N, puzzle_sets[p].first_seed + i);
+			reference_moves[i] = -1;
+
+			for(int h = 0; h < num_heuristics; h++){
+				//Only the heuristics that are really used for this N, the rest would just fall back to linear conflicts
+				if((heuristics[h] == HEURISTIC_WALKING_DISTANCE && walking_distance_loaded(N) == 0)
+				   || (heuristics[h] == HEURISTIC_PATTERN_DATABASE && (N != PATTERN_DATABASE_N || pattern_database_loaded() == 0))){
+					continue;
+				}
+
+				for(int c = 0; c < num_configurations; c++){
+					//The distance table is only for the 3x3, and it's only built for one
+					if(configurations[c].engine == SOLVER_ENGINE_TABLE && N != DISTANCE_TABLE_N){
+						continue;
+					}
+
+					struct solver_options options = default_solver_options(N);
+					options.engine = configurations[c].engine;
+					options.expansion = configurations[c].expansion;
+					options.fringe = configurations[c].fringe;
+					options.pruning = configurations[c].pruning;
+					options.heuristic = heuristics[h];
+					//Anytime search has to run until it has proven its solution optimal to be compared
+					options.time_budget = 0;
+
+					struct solution* solution = solve(N, duplicate_start_state(starts[i], N), goal, 0, &options);
+					solves++;
+
+					if(solution == NULL || verify_solution(solution, goal, N) == 0){
+						printf("FAILED: %s with %s did not solve %dx%d puzzle %d\n", configurations[c].name, heuristic_names[h], N, N, i);
+						failures++;
+					} else if(reference_moves[i] == -1){
+						//The very first solve is the reference, and the one that goes into the cache
+						reference_moves[i] = solution->num_moves;
+						solution_cache_insert(solution, N, 1.0);
+					//Reduction never looks for the shortest solution, so it only has to work
+					} else if(configurations[c].engine != SOLVER_ENGINE_REDUCTION && solution->num_moves != reference_moves[i]){
+						printf("FAILED: %s with %s took %d moves on %dx%d puzzle %d, A* took %d\n", configurations[c].name,
+							   heuristic_names[h], solution->num_moves, N, N, i, reference_moves[i]);
+						failures++;
+					}
+
+					if(solution != NULL){
+						destroy_solution(solution);
+					}
+				}
+			}
+		}
+
+		//Everything that was solved is in the cache now, along with its mirror image
+		if(reference_moves[0] != -1){
+			failures += verify_lookups(starts, reference_moves, num_puzzles, goal, N);
+		}
+
+		for(int i = 0; i < num_puzzles; i++){
+			destroy_state(starts[i], N);
+			free(starts[i]);
+		}
+
+		destroy_state(goal, N);
+		free(goal);
+	}
+
+	//Throw the cache away and open the store up again, so that every lookup has to be answered from the file
+	destroy_solution_cache();
+	close_solution_store();
+
+	if(initialize_solution_cache(SOLUTION_CACHE_DEFAULT_BYTES) != 0 || open_solution_store(store_file) != 0){
+		printf("FAILED: Could not open the solution store %s again\n", store_file);
+		failures++;
+	} else {
+		long lookups = 0;
+
+		for(int p = 0; p < num_puzzle_sets; p++){
+			const int N = puzzle_sets[p].N;
+			const int num_puzzles = puzzle_sets[p].num_puzzles;
+			struct state* goal = initialize_goal(N);
+
+			for(int i = 0; i < num_puzzles; i++){
+				struct state* start = generate_start_config(puzzle_sets[p].complexity, N, puzzle_sets[p].first_seed + i);
+				double suboptimality_bound;
+				struct solution* solution = solution_cache_lookup(start, N, &suboptimality_bound);
+				lookups++;
+
+				//The length was already checked against A*, the store only has to give back a solution that works
+				if(solution == NULL || verify_solution(solution, goal, N) == 0){
+					printf("FAILED: %dx%d puzzle %d did not come back out of the solution store\n", N, N, i);
+					failures++;
+				}
+
+				if(solution != NULL){
+					destroy_solution(solution);
+				}
+
+				destroy_state(start, N);
+				free(start);
+			}
+
+			destroy_state(goal, N);
+			free(goal);
+		}
+
+		struct solution_cache_statistics statistics;
+		get_solution_cache_statistics(&statistics);
+		if(statistics.store_hits != lookups){
+			printf("FAILED: Only %ld of %ld lookups were answered from the solution store\n", statistics.store_hits, lookups);
+			failures++;
+		}
+	}
+
+	destroy_solution_cache();
+	close_solution_store();
+	unlink(store_file);
+
+	if(failures == 0){
+		printf("Passed: every one of %ld solves agreed, and every solution came back out of the cache and the store\n", solves);
+	} else {
+		printf("%d failures\n", failures);
+	}
+
+	return failures;
+}
+
+
 /**
  * Run the server side methods to make this a truly "remote" N Puzzle Solver
  */
 int run_server(){
+	//Load the pattern database once, up front, so that every request's solver shares it
+	load_heuristics(1);
+	//Every connection thread shares the one solution cache
+	if(initialize_solution_cache(SOLUTION_CACHE_DEFAULT_BYTES) != 0){
+		printf("Could not set up the solution cache, every puzzle will be solved from scratch\n");
+	}
+	//Pick up every solution that an earlier run found. Only the header is read, however many there are
+	if(open_solution_store(SOLUTION_STORE_FILE) == 0){
+		printf("Opened the solution store %s with %ld solutions\n", SOLUTION_STORE_FILE, solution_store_size());
+	} else {
+		printf("Could not open the solution store %s, solutions will only be kept in memory\n", SOLUTION_STORE_FILE);
+	}
+
 	struct Server server = create_server(AF_INET, 2023, SOCK_STREAM, 0, 20, INADDR_ANY);
 	run(&server);
+
+	//Every connection is done by the time that run returns, so nothing is using the cache or the store anymore
+	destroy_solution_cache();
+	//Make sure that every solution found in this run is written out for the next one
+	close_solution_store();
+	return 0;
+}
+
+/**
+ * Build the 4x4 pattern database and every walking distance table and write them out, so that later runs can load them
+ */
+int run_build_pattern_database(){
+	printf("Building the 4x4 pattern database, this only has to be done once...\n");
+
+	if(build_pattern_database(PATTERN_DATABASE_FILE) != 0){
+		printf("Error: Could not build the pattern database\n");
+		exit(1);
+	}
+
+	printf("Building the walking distance tables, this only has to be done once...\n");
+
+	for(int N = WALKING_DISTANCE_MIN_N; N <= WALKING_DISTANCE_MAX_N; N++){
+		if(build_walking_distance(N) != 0){
+			printf("Error: Could not build the %dx%d walking distance table\n", N, N);
+			exit(1);
+		}
+	}
+
 	return 0;
 }
 
+
 /**
  * Our main function here will use getopt to split apart our command line
  * arguments. It will be possible to use debug mode to void all of the server
@@ -65,8 +541,17 @@ int run_server(){
 int main(int argc, char** argv){	
 	char opt;
 
+	//Pick the tile comparison kernel for this processor before anything is solved
+	initialize_simd_kernels();
+	//Find the duplicate move sequences and build the machines that prune them, every solve only ever reads them
+	for(int N = 3; N <= MOVE_PRUNING_MAX_N; N++){
+		initialize_move_pruning(N);
+	}
+	//Every 3x3 is answered out of the distance table, which is small and quick enough to build every time
+	initialize_distance_table();
+
 	//The user can decide to initialize in remote server mode in command line mode
-	while((opt = getopt(argc, argv, "dr")) != -1){
+	while((opt = getopt(argc, argv, "drbpt")) != -1){
 		//Based on our option here
 		switch(opt){
 			//User wants debug mode
@@ -79,6 +564,21 @@ int main(int argc, char** argv){
 				run_server();
 				//Server run method
 				break;
+			//User wants to benchmark the solver
+			case 'b':
+				run_benchmark();
+				break;
+			//User wants to build the pattern database
+			case 'p':
+				run_build_pattern_database();
+				break;
+			//User wants to make sure that every engine agrees
+			case 't':
+				//Any failure has to show up in the exit status
+				if(run_verification() != 0){
+					exit(1);
+				}
+				break;
 			//Unknown/default case
 			case '?':
 			default: